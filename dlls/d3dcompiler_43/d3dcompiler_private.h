@@ -754,6 +754,7 @@ struct hlsl_ir_var
     const char *semantic;
     unsigned int modifiers;
     struct list scope_entry;
+    struct wine_rb_entry scope_tree_entry;
 
     struct hlsl_var_allocation *allocation;
 };
@@ -951,6 +952,7 @@ struct hlsl_scope
 {
     struct list entry;
     struct list vars;
+    struct wine_rb_tree vars_tree;
     struct wine_rb_tree types;
     struct hlsl_scope *upper;
 };
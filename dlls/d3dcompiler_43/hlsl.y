@@ -2470,6 +2470,7 @@ struct bwriter_shader *parse_hlsl(enum shader_type type, DWORD major, DWORD mino
         {
             free_declaration(var);
         }
+        wine_rb_destroy(&scope->vars_tree, NULL, NULL);
         wine_rb_destroy(&scope->types, NULL, NULL);
         d3dcompiler_free(scope);
     }
@@ -90,6 +90,14 @@ struct d3dcompiler_shader_reflection_constant_buffer
     struct d3dcompiler_shader_reflection_variable *variables;
 };
 
+/* Entries of the sorted name indices used by the *ByName() lookups. */
+struct d3dcompiler_name_entry
+{
+    const char *name;
+    unsigned int order;
+    void *object;
+};
+
 /* ID3D11ShaderReflection */
 struct d3dcompiler_shader_reflection
 {
@@ -137,6 +145,13 @@ struct d3dcompiler_shader_reflection
     D3D11_SHADER_INPUT_BIND_DESC *bound_resources;
     struct d3dcompiler_shader_reflection_constant_buffer *constant_buffers;
     struct wine_rb_tree types;
+
+    struct d3dcompiler_name_entry *constant_buffer_names;
+    struct d3dcompiler_name_entry *variable_names;
+    struct d3dcompiler_name_entry *bound_resource_names;
+    UINT constant_buffer_name_count;
+    UINT variable_name_count;
+    UINT bound_resource_name_count;
 };
 
 static struct d3dcompiler_shader_reflection_type *get_reflection_type(struct d3dcompiler_shader_reflection *reflection, const char *data, DWORD offset);
@@ -191,6 +206,36 @@ static BOOL copy_value(const char *ptr, void **value, DWORD size)
     return TRUE;
 }
 
+static int d3dcompiler_name_entry_compare(const void *a, const void *b)
+{
+    const struct d3dcompiler_name_entry *e1 = a, *e2 = b;
+    int ret;
+
+    if ((ret = strcmp(e1->name, e2->name)))
+        return ret;
+    return e1->order < e2->order ? -1 : e1->order > e2->order;
+}
+
+/* Returns the first entry, in declaration order, with the given name. */
+static void *d3dcompiler_find_name(const struct d3dcompiler_name_entry *entries, UINT count, const char *name)
+{
+    UINT low = 0, high = count;
+
+    while (low < high)
+    {
+        UINT mid = low + (high - low) / 2;
+
+        if (strcmp(entries[mid].name, name) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < count && !strcmp(entries[low].name, name))
+        return entries[low].object;
+    return NULL;
+}
+
 static void *d3dcompiler_rb_alloc(size_t size)
 {
     return HeapAlloc(GetProcessHeap(), 0, size);
@@ -315,6 +360,9 @@ static void reflection_cleanup(struct d3dcompiler_shader_reflection *ref)
     }
 
     wine_rb_destroy(&ref->types, d3dcompiler_shader_reflection_type_destroy, NULL);
+    HeapFree(GetProcessHeap(), 0, ref->constant_buffer_names);
+    HeapFree(GetProcessHeap(), 0, ref->variable_names);
+    HeapFree(GetProcessHeap(), 0, ref->bound_resource_names);
     HeapFree(GetProcessHeap(), 0, ref->constant_buffers);
     HeapFree(GetProcessHeap(), 0, ref->bound_resources);
     HeapFree(GetProcessHeap(), 0, ref->resource_string);
@@ -448,7 +496,7 @@ static struct ID3D11ShaderReflectionConstantBuffer * STDMETHODCALLTYPE d3dcompil
         ID3D11ShaderReflection *iface, const char *name)
 {
     struct d3dcompiler_shader_reflection *This = impl_from_ID3D11ShaderReflection(iface);
-    unsigned int i;
+    struct d3dcompiler_shader_reflection_constant_buffer *d;
 
     TRACE("iface %p, name %s\n", iface, debugstr_a(name));
 
@@ -458,15 +506,10 @@ static struct ID3D11ShaderReflectionConstantBuffer * STDMETHODCALLTYPE d3dcompil
         return &null_constant_buffer.ID3D11ShaderReflectionConstantBuffer_iface;
     }
 
-    for (i = 0; i < This->constant_buffer_count; ++i)
+    if ((d = d3dcompiler_find_name(This->constant_buffer_names, This->constant_buffer_name_count, name)))
     {
-        struct d3dcompiler_shader_reflection_constant_buffer *d = &This->constant_buffers[i];
-
-        if (!strcmp(d->name, name))
-        {
-            TRACE("Returning ID3D11ShaderReflectionConstantBuffer %p.\n", d);
-            return &d->ID3D11ShaderReflectionConstantBuffer_iface;
-        }
+        TRACE("Returning ID3D11ShaderReflectionConstantBuffer %p.\n", d);
+        return &d->ID3D11ShaderReflectionConstantBuffer_iface;
     }
 
     WARN("Invalid name specified\n");
@@ -550,7 +593,7 @@ static struct ID3D11ShaderReflectionVariable * STDMETHODCALLTYPE d3dcompiler_sha
         ID3D11ShaderReflection *iface, const char *name)
 {
     struct d3dcompiler_shader_reflection *This = impl_from_ID3D11ShaderReflection(iface);
-    unsigned int i, k;
+    struct d3dcompiler_shader_reflection_variable *v;
 
     TRACE("iface %p, name %s\n", iface, debugstr_a(name));
 
@@ -560,20 +603,10 @@ static struct ID3D11ShaderReflectionVariable * STDMETHODCALLTYPE d3dcompiler_sha
         return &null_variable.ID3D11ShaderReflectionVariable_iface;
     }
 
-    for (i = 0; i < This->constant_buffer_count; ++i)
+    if ((v = d3dcompiler_find_name(This->variable_names, This->variable_name_count, name)))
     {
-        struct d3dcompiler_shader_reflection_constant_buffer *cb = &This->constant_buffers[i];
-
-        for (k = 0; k < cb->variable_count; ++k)
-        {
-            struct d3dcompiler_shader_reflection_variable *v = &cb->variables[k];
-
-            if (!strcmp(v->name, name))
-            {
-                TRACE("Returning ID3D11ShaderReflectionVariable %p.\n", v);
-                return &v->ID3D11ShaderReflectionVariable_iface;
-            }
-        }
+        TRACE("Returning ID3D11ShaderReflectionVariable %p.\n", v);
+        return &v->ID3D11ShaderReflectionVariable_iface;
     }
 
     WARN("Invalid name specified\n");
@@ -585,7 +618,7 @@ static HRESULT STDMETHODCALLTYPE d3dcompiler_shader_reflection_GetResourceBindin
         ID3D11ShaderReflection *iface, const char *name, D3D11_SHADER_INPUT_BIND_DESC *desc)
 {
     struct d3dcompiler_shader_reflection *This = impl_from_ID3D11ShaderReflection(iface);
-    unsigned int i;
+    D3D11_SHADER_INPUT_BIND_DESC *d;
 
     TRACE("iface %p, name %s, desc %p\n", iface, debugstr_a(name), desc);
 
@@ -595,16 +628,11 @@ static HRESULT STDMETHODCALLTYPE d3dcompiler_shader_reflection_GetResourceBindin
         return E_INVALIDARG;
     }
 
-    for (i = 0; i < This->bound_resource_count; ++i)
+    if ((d = d3dcompiler_find_name(This->bound_resource_names, This->bound_resource_name_count, name)))
     {
-        D3D11_SHADER_INPUT_BIND_DESC *d = &This->bound_resources[i];
-
-        if (!strcmp(d->Name, name))
-        {
-            TRACE("Returning D3D11_SHADER_INPUT_BIND_DESC %p.\n", d);
-            *desc = *d;
-            return S_OK;
-        }
+        TRACE("Returning D3D11_SHADER_INPUT_BIND_DESC %p.\n", d);
+        *desc = *d;
+        return S_OK;
     }
 
     WARN("Invalid name specified\n");
@@ -1676,6 +1704,59 @@ static HRESULT d3dcompiler_parse_shdr(struct d3dcompiler_shader_reflection *r, c
     return S_OK;
 }
 
+static void d3dcompiler_add_name(struct d3dcompiler_name_entry *entries, UINT *count,
+        const char *name, void *object)
+{
+    if (!name)
+        return;
+
+    entries[*count].name = name;
+    entries[*count].order = *count;
+    entries[*count].object = object;
+    ++*count;
+}
+
+/* Sort the constant buffer, variable and resource names once, so that the
+ * *ByName() lookups don't have to walk every entry. */
+static HRESULT d3dcompiler_build_name_indices(struct d3dcompiler_shader_reflection *r)
+{
+    UINT i, k, variable_count = 0;
+
+    for (i = 0; i < r->constant_buffer_count; ++i)
+        variable_count += r->constant_buffers[i].variable_count;
+
+    if (r->constant_buffer_count && !(r->constant_buffer_names = HeapAlloc(GetProcessHeap(), 0,
+            r->constant_buffer_count * sizeof(*r->constant_buffer_names))))
+        return E_OUTOFMEMORY;
+    if (variable_count && !(r->variable_names = HeapAlloc(GetProcessHeap(), 0,
+            variable_count * sizeof(*r->variable_names))))
+        return E_OUTOFMEMORY;
+    if (r->bound_resource_count && !(r->bound_resource_names = HeapAlloc(GetProcessHeap(), 0,
+            r->bound_resource_count * sizeof(*r->bound_resource_names))))
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < r->constant_buffer_count; ++i)
+    {
+        struct d3dcompiler_shader_reflection_constant_buffer *cb = &r->constant_buffers[i];
+
+        d3dcompiler_add_name(r->constant_buffer_names, &r->constant_buffer_name_count, cb->name, cb);
+        for (k = 0; k < cb->variable_count; ++k)
+            d3dcompiler_add_name(r->variable_names, &r->variable_name_count, cb->variables[k].name, &cb->variables[k]);
+    }
+    for (i = 0; i < r->bound_resource_count; ++i)
+        d3dcompiler_add_name(r->bound_resource_names, &r->bound_resource_name_count,
+                r->bound_resources[i].Name, &r->bound_resources[i]);
+
+    qsort(r->constant_buffer_names, r->constant_buffer_name_count,
+            sizeof(*r->constant_buffer_names), d3dcompiler_name_entry_compare);
+    qsort(r->variable_names, r->variable_name_count,
+            sizeof(*r->variable_names), d3dcompiler_name_entry_compare);
+    qsort(r->bound_resource_names, r->bound_resource_name_count,
+            sizeof(*r->bound_resource_names), d3dcompiler_name_entry_compare);
+
+    return S_OK;
+}
+
 static HRESULT d3dcompiler_shader_reflection_init(struct d3dcompiler_shader_reflection *reflection,
         const void *data, SIZE_T data_size)
 {
@@ -1791,6 +1872,12 @@ static HRESULT d3dcompiler_shader_reflection_init(struct d3dcompiler_shader_refl
         }
     }
 
+    if (FAILED(hr = d3dcompiler_build_name_indices(reflection)))
+    {
+        ERR("Failed to build name indices.\n");
+        goto err_out;
+    }
+
     dxbc_destroy(&src_dxbc);
 
     return hr;
@@ -763,39 +763,28 @@ void compilation_message(struct compilation_messages *msg, const char *fmt, va_l
 
 BOOL add_declaration(struct hlsl_scope *scope, struct hlsl_ir_var *decl, BOOL local_var)
 {
-    struct hlsl_ir_var *var;
-
-    LIST_FOR_EACH_ENTRY(var, &scope->vars, struct hlsl_ir_var, scope_entry)
-    {
-        if (!strcmp(decl->name, var->name))
-            return FALSE;
-    }
-    if (local_var && scope->upper->upper == hlsl_ctx.globals)
-    {
-        /* Check whether the variable redefines a function parameter. */
-        LIST_FOR_EACH_ENTRY(var, &scope->upper->vars, struct hlsl_ir_var, scope_entry)
-        {
-            if (!strcmp(decl->name, var->name))
-                return FALSE;
-        }
-    }
+    if (wine_rb_get(&scope->vars_tree, decl->name))
+        return FALSE;
+    /* Check whether the variable redefines a function parameter. */
+    if (local_var && scope->upper->upper == hlsl_ctx.globals
+            && wine_rb_get(&scope->upper->vars_tree, decl->name))
+        return FALSE;
 
+    wine_rb_put(&scope->vars_tree, decl->name, &decl->scope_tree_entry);
     list_add_tail(&scope->vars, &decl->scope_entry);
     return TRUE;
 }
 
 struct hlsl_ir_var *get_variable(struct hlsl_scope *scope, const char *name)
 {
-    struct hlsl_ir_var *var;
+    struct wine_rb_entry *entry;
 
-    LIST_FOR_EACH_ENTRY(var, &scope->vars, struct hlsl_ir_var, scope_entry)
+    for (; scope; scope = scope->upper)
     {
-        if (!strcmp(name, var->name))
-            return var;
+        if ((entry = wine_rb_get(&scope->vars_tree, name)))
+            return WINE_RB_ENTRY_VALUE(entry, struct hlsl_ir_var, scope_tree_entry);
     }
-    if (!scope->upper)
-        return NULL;
-    return get_variable(scope->upper, name);
+    return NULL;
 }
 
 void free_declaration(struct hlsl_ir_var *decl)
@@ -1702,6 +1691,13 @@ static int compare_hlsl_types_rb(const void *key, const struct wine_rb_entry *en
     return strcmp(name, type->name);
 }
 
+static int compare_hlsl_vars_rb(const void *key, const struct wine_rb_entry *entry)
+{
+    const struct hlsl_ir_var *var = WINE_RB_ENTRY_VALUE(entry, const struct hlsl_ir_var, scope_tree_entry);
+
+    return strcmp(key, var->name);
+}
+
 static inline void *d3dcompiler_alloc_rb(size_t size)
 {
     return d3dcompiler_alloc(size);
@@ -1724,6 +1720,14 @@ static const struct wine_rb_functions hlsl_type_rb_funcs =
     compare_hlsl_types_rb,
 };
 
+static const struct wine_rb_functions hlsl_var_rb_funcs =
+{
+    d3dcompiler_alloc_rb,
+    d3dcompiler_realloc_rb,
+    d3dcompiler_free_rb,
+    compare_hlsl_vars_rb,
+};
+
 void push_scope(struct hlsl_parse_ctx *ctx)
 {
     struct hlsl_scope *new_scope = d3dcompiler_alloc(sizeof(*new_scope));
@@ -1735,9 +1739,16 @@ void push_scope(struct hlsl_parse_ctx *ctx)
     }
     TRACE("Pushing a new scope\n");
     list_init(&new_scope->vars);
+    if (wine_rb_init(&new_scope->vars_tree, &hlsl_var_rb_funcs) == -1)
+    {
+        ERR("Failed to initialize variables rbtree.\n");
+        d3dcompiler_free(new_scope);
+        return;
+    }
     if (wine_rb_init(&new_scope->types, &hlsl_type_rb_funcs) == -1)
     {
         ERR("Failed to initialize types rbtree.\n");
+        wine_rb_destroy(&new_scope->vars_tree, NULL, NULL);
         d3dcompiler_free(new_scope);
         return;
     }
@@ -403,12 +403,12 @@ D3DXMATRIX* WINAPI D3DXMatrixMultiply(D3DXMATRIX *pout, const D3DXMATRIX *pm1, c
 
     TRACE("pout %p, pm1 %p, pm2 %p\n", pout, pm1, pm2);
 
-    for (i=0; i<4; i++)
+    for (i = 0; i < 4; ++i)
     {
-        for (j=0; j<4; j++)
-        {
-            out.u.m[i][j] = pm1->u.m[i][0] * pm2->u.m[0][j] + pm1->u.m[i][1] * pm2->u.m[1][j] + pm1->u.m[i][2] * pm2->u.m[2][j] + pm1->u.m[i][3] * pm2->u.m[3][j];
-        }
+        const FLOAT a0 = pm1->u.m[i][0], a1 = pm1->u.m[i][1], a2 = pm1->u.m[i][2], a3 = pm1->u.m[i][3];
+
+        for (j = 0; j < 4; ++j)
+            out.u.m[i][j] = a0 * pm2->u.m[0][j] + a1 * pm2->u.m[1][j] + a2 * pm2->u.m[2][j] + a3 * pm2->u.m[3][j];
     }
 
     *pout = out;
@@ -1331,14 +1331,23 @@ D3DXPLANE* WINAPI D3DXPlaneTransform(D3DXPLANE *pout, const D3DXPLANE *pplane, c
 D3DXPLANE* WINAPI D3DXPlaneTransformArray(D3DXPLANE* out, UINT outstride, const D3DXPLANE* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2], m13 = matrix->u.m[1][3];
+    const FLOAT m20 = matrix->u.m[2][0], m21 = matrix->u.m[2][1], m22 = matrix->u.m[2][2], m23 = matrix->u.m[2][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m32 = matrix->u.m[3][2], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXPlaneTransform(
-            (D3DXPLANE*)((char*)out + outstride * i),
-            (const D3DXPLANE*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXPLANE *v = (const D3DXPLANE *)((const char *)in + instride * i);
+        D3DXPLANE *o = (D3DXPLANE *)((char *)out + outstride * i);
+        const FLOAT a = v->a, b = v->b, c = v->c, d = v->d;
+
+        o->a = m00 * a + m10 * b + m20 * c + m30 * d;
+        o->b = m01 * a + m11 * b + m21 * c + m31 * d;
+        o->c = m02 * a + m12 * b + m22 * c + m32 * d;
+        o->d = m03 * a + m13 * b + m23 * c + m33 * d;
     }
     return out;
 }
@@ -1729,14 +1738,22 @@ D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv,
 D3DXVECTOR4* WINAPI D3DXVec2TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2], m13 = matrix->u.m[1][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m32 = matrix->u.m[3][2], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 *v = (const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y;
+
+        o->x = m00 * x + m10 * y + m30;
+        o->y = m01 * x + m11 * y + m31;
+        o->z = m02 * x + m12 * y + m32;
+        o->w = m03 * x + m13 * y + m33;
     }
     return out;
 }
@@ -1760,14 +1777,21 @@ D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2
 D3DXVECTOR2* WINAPI D3DXVec2TransformCoordArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m13 = matrix->u.m[1][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformCoord(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 *v = (const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR2 *o = (D3DXVECTOR2 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y;
+        const FLOAT norm = m03 * x + m13 * y + m33;
+
+        o->x = (m00 * x + m10 * y + m30) / norm;
+        o->y = (m01 * x + m11 * y + m31) / norm;
     }
     return out;
 }
@@ -1786,14 +1810,19 @@ D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2
 D3DXVECTOR2* WINAPI D3DXVec2TransformNormalArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2 *in, UINT instride, const D3DXMATRIX *matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformNormal(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 *v = (const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR2 *o = (D3DXVECTOR2 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y;
+
+        o->x = m00 * x + m10 * y;
+        o->y = m01 * x + m11 * y;
     }
     return out;
 }
@@ -1912,14 +1941,23 @@ D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv,
 D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2], m13 = matrix->u.m[1][3];
+    const FLOAT m20 = matrix->u.m[2][0], m21 = matrix->u.m[2][1], m22 = matrix->u.m[2][2], m23 = matrix->u.m[2][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m32 = matrix->u.m[3][2], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 *v = (const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y, z = v->z;
+
+        o->x = m00 * x + m10 * y + m20 * z + m30;
+        o->y = m01 * x + m11 * y + m21 * z + m31;
+        o->z = m02 * x + m12 * y + m22 * z + m32;
+        o->w = m03 * x + m13 * y + m23 * z + m33;
     }
     return out;
 }
@@ -1945,14 +1983,23 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoordArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2], m13 = matrix->u.m[1][3];
+    const FLOAT m20 = matrix->u.m[2][0], m21 = matrix->u.m[2][1], m22 = matrix->u.m[2][2], m23 = matrix->u.m[2][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m32 = matrix->u.m[3][2], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformCoord(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 *v = (const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR3 *o = (D3DXVECTOR3 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y, z = v->z;
+        const FLOAT norm = m03 * x + m13 * y + m23 * z + m33;
+
+        o->x = (m00 * x + m10 * y + m20 * z + m30) / norm;
+        o->y = (m01 * x + m11 * y + m21 * z + m31) / norm;
+        o->z = (m02 * x + m12 * y + m22 * z + m32) / norm;
     }
     return out;
 }
@@ -1973,14 +2020,21 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormalArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2];
+    const FLOAT m20 = matrix->u.m[2][0], m21 = matrix->u.m[2][1], m22 = matrix->u.m[2][2];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformNormal(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 *v = (const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR3 *o = (D3DXVECTOR3 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y, z = v->z;
+
+        o->x = m00 * x + m10 * y + m20 * z;
+        o->y = m01 * x + m11 * y + m21 * z;
+        o->z = m02 * x + m12 * y + m22 * z;
     }
     return out;
 }
@@ -2113,14 +2167,23 @@ D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv,
 D3DXVECTOR4* WINAPI D3DXVec4TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR4* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
     UINT i;
+    const FLOAT m00 = matrix->u.m[0][0], m01 = matrix->u.m[0][1], m02 = matrix->u.m[0][2], m03 = matrix->u.m[0][3];
+    const FLOAT m10 = matrix->u.m[1][0], m11 = matrix->u.m[1][1], m12 = matrix->u.m[1][2], m13 = matrix->u.m[1][3];
+    const FLOAT m20 = matrix->u.m[2][0], m21 = matrix->u.m[2][1], m22 = matrix->u.m[2][2], m23 = matrix->u.m[2][3];
+    const FLOAT m30 = matrix->u.m[3][0], m31 = matrix->u.m[3][1], m32 = matrix->u.m[3][2], m33 = matrix->u.m[3][3];
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec4Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR4*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR4 *v = (const D3DXVECTOR4 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+        const FLOAT x = v->x, y = v->y, z = v->z, w = v->w;
+
+        o->x = m00 * x + m10 * y + m20 * z + m30 * w;
+        o->y = m01 * x + m11 * y + m21 * z + m31 * w;
+        o->z = m02 * x + m12 * y + m22 * z + m32 * w;
+        o->w = m03 * x + m13 * y + m23 * z + m33 * w;
     }
     return out;
 }
@@ -1645,6 +1645,411 @@ static HRESULT remap_faces_for_attrsort(struct d3dx9_mesh *This, const DWORD *in
     return D3D_OK;
 }
 
+/* Vertex cache optimization, based on Tom Forsyth's "Linear-Speed Vertex
+ * Cache Optimisation". Faces are emitted greedily, always picking the face
+ * whose vertices score highest; vertices score higher when they are in the
+ * simulated cache and when few of their faces are left. */
+#define VCACHE_MAX_SIZE 32
+
+struct vcache_vertex
+{
+    DWORD live_faces;
+    DWORD face_start;
+    DWORD added_faces;
+    int cache_pos;
+    float score;
+};
+
+struct vcache_optimizer
+{
+    struct vcache_vertex *vertices;
+    DWORD *vertex_faces;
+    BOOL *face_done;
+    unsigned int cache_size;
+    float cache_scores[VCACHE_MAX_SIZE];
+};
+
+static float vcache_vertex_score(const struct vcache_optimizer *opt, const struct vcache_vertex *vertex)
+{
+    float score;
+
+    if (!vertex->live_faces)
+        return -1.0f;
+
+    score = vertex->cache_pos < 0 ? 0.0f : opt->cache_scores[vertex->cache_pos];
+    return score + 2.0f / sqrtf(vertex->live_faces);
+}
+
+static float vcache_face_score(const struct vcache_optimizer *opt, const DWORD *indices, DWORD face)
+{
+    return opt->vertices[indices[face * 3]].score
+            + opt->vertices[indices[face * 3 + 1]].score
+            + opt->vertices[indices[face * 3 + 2]].score;
+}
+
+static HRESULT vcache_optimizer_init(struct vcache_optimizer *opt, DWORD num_vertices,
+        DWORD num_faces, unsigned int cache_size)
+{
+    unsigned int i;
+
+    opt->vertices = HeapAlloc(GetProcessHeap(), 0, num_vertices * sizeof(*opt->vertices));
+    opt->vertex_faces = HeapAlloc(GetProcessHeap(), 0, num_faces * 3 * sizeof(*opt->vertex_faces));
+    opt->face_done = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, num_faces * sizeof(*opt->face_done));
+    if (!opt->vertices || !opt->vertex_faces || !opt->face_done)
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < num_vertices; ++i)
+    {
+        opt->vertices[i].live_faces = 0;
+        opt->vertices[i].face_start = ~0u;
+        opt->vertices[i].added_faces = 0;
+        opt->vertices[i].cache_pos = -1;
+    }
+
+    opt->cache_size = cache_size;
+    for (i = 0; i < cache_size; ++i)
+    {
+        /* The last face's vertices get a fixed score, so that the next face
+         * doesn't necessarily reuse the same edge. */
+        if (i < 3)
+            opt->cache_scores[i] = 0.75f;
+        else
+            opt->cache_scores[i] = powf(1.0f - (float)(i - 3) / (cache_size - 3), 1.5f);
+    }
+
+    return D3D_OK;
+}
+
+static void vcache_optimizer_cleanup(struct vcache_optimizer *opt)
+{
+    HeapFree(GetProcessHeap(), 0, opt->vertices);
+    HeapFree(GetProcessHeap(), 0, opt->vertex_faces);
+    HeapFree(GetProcessHeap(), 0, opt->face_done);
+}
+
+/* Reorder the faces start..end-1 of indices. order receives the new face
+ * order, as indices into the same face range. */
+static void vcache_optimize_faces(struct vcache_optimizer *opt, const DWORD *indices,
+        DWORD start, DWORD end, DWORD *order)
+{
+    DWORD cache[VCACHE_MAX_SIZE + 3], new_cache[VCACHE_MAX_SIZE + 3];
+    unsigned int cache_count = 0, new_count, i, j, k;
+    DWORD face, next_face, cursor = start, pos = start;
+    DWORD offset = 0;
+    float score, best_score;
+
+    /* Build the per-vertex face lists. */
+    for (i = start * 3; i < end * 3; ++i)
+        ++opt->vertices[indices[i]].live_faces;
+    for (i = start * 3; i < end * 3; ++i)
+    {
+        struct vcache_vertex *vertex = &opt->vertices[indices[i]];
+
+        if (vertex->face_start == ~0u)
+        {
+            vertex->face_start = offset;
+            offset += vertex->live_faces;
+        }
+        opt->vertex_faces[vertex->face_start + vertex->added_faces++] = i / 3;
+    }
+
+    for (i = start * 3; i < end * 3; ++i)
+        opt->vertices[indices[i]].score = vcache_vertex_score(opt, &opt->vertices[indices[i]]);
+
+    next_face = ~0u;
+    best_score = -1.0f;
+    for (face = start; face < end; ++face)
+    {
+        if ((score = vcache_face_score(opt, indices, face)) > best_score)
+        {
+            best_score = score;
+            next_face = face;
+        }
+    }
+
+    while (pos < end)
+    {
+        if (next_face == ~0u)
+        {
+            /* Nothing left in the cache, continue with the first face that
+             * wasn't emitted yet. */
+            while (opt->face_done[cursor])
+                ++cursor;
+            next_face = cursor;
+        }
+
+        face = next_face;
+        order[pos++] = face;
+        opt->face_done[face] = TRUE;
+
+        new_count = 0;
+        for (i = 0; i < 3; ++i)
+        {
+            DWORD index = indices[face * 3 + i];
+            struct vcache_vertex *vertex = &opt->vertices[index];
+            DWORD *faces = &opt->vertex_faces[vertex->face_start];
+
+            for (j = 0; j < vertex->live_faces; ++j)
+            {
+                if (faces[j] == face)
+                {
+                    faces[j] = faces[--vertex->live_faces];
+                    break;
+                }
+            }
+
+            for (j = 0; j < new_count; ++j)
+            {
+                if (new_cache[j] == index)
+                    break;
+            }
+            if (j == new_count)
+                new_cache[new_count++] = index;
+        }
+        for (i = 0; i < cache_count; ++i)
+        {
+            for (j = 0; j < 3; ++j)
+            {
+                if (cache[i] == indices[face * 3 + j])
+                    break;
+            }
+            if (j == 3)
+                new_cache[new_count++] = cache[i];
+        }
+
+        /* Update the scores of everything that was in the cache, including
+         * the vertices that just dropped out of it. */
+        for (i = 0; i < new_count; ++i)
+        {
+            struct vcache_vertex *vertex = &opt->vertices[new_cache[i]];
+
+            vertex->cache_pos = i < opt->cache_size ? i : -1;
+            vertex->score = vcache_vertex_score(opt, vertex);
+        }
+
+        next_face = ~0u;
+        best_score = -1.0f;
+        for (i = 0; i < new_count; ++i)
+        {
+            const struct vcache_vertex *vertex = &opt->vertices[new_cache[i]];
+
+            for (j = 0; j < vertex->live_faces; ++j)
+            {
+                DWORD other = opt->vertex_faces[vertex->face_start + j];
+
+                if ((score = vcache_face_score(opt, indices, other)) > best_score)
+                {
+                    best_score = score;
+                    next_face = other;
+                }
+            }
+        }
+
+        cache_count = min(new_count, opt->cache_size);
+        memcpy(cache, new_cache, cache_count * sizeof(*cache));
+    }
+
+    /* Reset the vertex state for the next range. */
+    for (i = start * 3; i < end * 3; ++i)
+    {
+        struct vcache_vertex *vertex = &opt->vertices[indices[i]];
+
+        vertex->live_faces = 0;
+        vertex->face_start = ~0u;
+        vertex->added_faces = 0;
+        vertex->cache_pos = -1;
+    }
+    for (k = start; k < end; ++k)
+        opt->face_done[k] = FALSE;
+}
+
+/* Reorder the faces start..end-1 so that consecutive faces are adjacent
+ * where possible, walking greedily towards the neighbour with the fewest
+ * remaining neighbours of its own. */
+static void strip_reorder_faces(const DWORD *neighbours, BOOL *face_done, DWORD *neighbour_count,
+        DWORD start, DWORD end, DWORD *order)
+{
+    DWORD face, next_face = ~0u, cursor = start, pos = start;
+    unsigned int i;
+
+    for (face = start; face < end; ++face)
+    {
+        neighbour_count[face] = 0;
+        for (i = 0; i < 3; ++i)
+        {
+            DWORD neighbour = neighbours[face * 3 + i];
+            if (neighbour >= start && neighbour < end)
+                ++neighbour_count[face];
+        }
+    }
+
+    while (pos < end)
+    {
+        if (next_face == ~0u)
+        {
+            while (face_done[cursor])
+                ++cursor;
+            next_face = cursor;
+        }
+
+        face = next_face;
+        order[pos++] = face;
+        face_done[face] = TRUE;
+
+        next_face = ~0u;
+        for (i = 0; i < 3; ++i)
+        {
+            DWORD neighbour = neighbours[face * 3 + i];
+
+            if (neighbour < start || neighbour >= end || face_done[neighbour])
+                continue;
+            --neighbour_count[neighbour];
+            if (next_face == ~0u || neighbour_count[neighbour] < neighbour_count[next_face])
+                next_face = neighbour;
+        }
+    }
+}
+
+/* Reorder the faces inside each attribute range for D3DXMESHOPT_VERTEXCACHE
+ * or D3DXMESHOPT_STRIPREORDER. face_remap is the old -> new mapping created
+ * by the attribute sort, and is updated in place. */
+static HRESULT remap_faces_for_vertex_cache(struct d3dx9_mesh *This, DWORD flags, const DWORD *indices,
+        const DWORD *sorted_attrib_buffer, const DWORD *adjacency, DWORD *face_remap)
+{
+    struct vcache_optimizer opt = {0};
+    DWORD *new_to_old, *new_indices = NULL, *order = NULL, *neighbours = NULL, *neighbour_count = NULL;
+    BOOL *face_done = NULL;
+    DWORD start, end, i;
+    HRESULT hr = E_OUTOFMEMORY;
+
+    if (!(new_to_old = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*new_to_old))))
+        return E_OUTOFMEMORY;
+    if (!(order = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*order))))
+        goto cleanup;
+
+    for (i = 0; i < This->numfaces; ++i)
+        new_to_old[face_remap[i]] = i;
+
+    if (flags & D3DXMESHOPT_VERTEXCACHE)
+    {
+        if (!(new_indices = HeapAlloc(GetProcessHeap(), 0, This->numfaces * 3 * sizeof(*new_indices))))
+            goto cleanup;
+        for (i = 0; i < This->numfaces; ++i)
+            memcpy(&new_indices[i * 3], &indices[new_to_old[i] * 3], 3 * sizeof(*new_indices));
+
+        /* The device independent cache size works well on older hardware. */
+        if (FAILED(hr = vcache_optimizer_init(&opt, This->numvertices, This->numfaces,
+                flags & D3DXMESHOPT_DEVICEINDEPENDENT ? 16 : VCACHE_MAX_SIZE)))
+            goto cleanup;
+    }
+    else
+    {
+        neighbours = HeapAlloc(GetProcessHeap(), 0, This->numfaces * 3 * sizeof(*neighbours));
+        neighbour_count = HeapAlloc(GetProcessHeap(), 0, This->numfaces * sizeof(*neighbour_count));
+        face_done = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, This->numfaces * sizeof(*face_done));
+        if (!neighbours || !neighbour_count || !face_done)
+            goto cleanup;
+        for (i = 0; i < This->numfaces * 3; ++i)
+        {
+            DWORD neighbour = adjacency[new_to_old[i / 3] * 3 + i % 3];
+            neighbours[i] = neighbour < This->numfaces ? face_remap[neighbour] : ~0u;
+        }
+    }
+
+    for (start = 0; start < This->numfaces; start = end)
+    {
+        for (end = start + 1; end < This->numfaces; ++end)
+        {
+            if (sorted_attrib_buffer[end] != sorted_attrib_buffer[start])
+                break;
+        }
+
+        if (flags & D3DXMESHOPT_VERTEXCACHE)
+            vcache_optimize_faces(&opt, new_indices, start, end, order);
+        else
+            strip_reorder_faces(neighbours, face_done, neighbour_count, start, end, order);
+    }
+
+    for (i = 0; i < This->numfaces; ++i)
+        face_remap[new_to_old[order[i]]] = i;
+
+    hr = D3D_OK;
+cleanup:
+    vcache_optimizer_cleanup(&opt);
+    HeapFree(GetProcessHeap(), 0, face_done);
+    HeapFree(GetProcessHeap(), 0, neighbour_count);
+    HeapFree(GetProcessHeap(), 0, neighbours);
+    HeapFree(GetProcessHeap(), 0, new_indices);
+    HeapFree(GetProcessHeap(), 0, order);
+    HeapFree(GetProcessHeap(), 0, new_to_old);
+    return hr;
+}
+
+/* Renumber the vertices in the order they are first used by the reordered
+ * faces, so that vertex fetches walk the vertex buffer sequentially. Unused
+ * vertices are moved to the end, or dropped when compacting. */
+static HRESULT remap_vertices_for_fetch(struct d3dx9_mesh *This, DWORD *indices, const DWORD *face_remap,
+        BOOL compact, DWORD *new_num_vertices, ID3DXBuffer **vertex_remap)
+{
+    DWORD *vertex_remap_ptr, *new_to_old;
+    DWORD num_used_vertices = 0;
+    DWORD i, j;
+    HRESULT hr;
+
+    if (!(new_to_old = HeapAlloc(GetProcessHeap(), 0, max(This->numfaces, This->numvertices) * sizeof(*new_to_old))))
+        return E_OUTOFMEMORY;
+
+    hr = D3DXCreateBuffer(This->numvertices * sizeof(DWORD), vertex_remap);
+    if (FAILED(hr))
+    {
+        HeapFree(GetProcessHeap(), 0, new_to_old);
+        return hr;
+    }
+    vertex_remap_ptr = ID3DXBuffer_GetBufferPointer(*vertex_remap);
+
+    /* create old->new vertex mapping */
+    for (i = 0; i < This->numvertices; ++i)
+        vertex_remap_ptr[i] = -1;
+    for (i = 0; i < This->numfaces; ++i)
+        new_to_old[face_remap[i]] = i;
+    for (i = 0; i < This->numfaces; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+        {
+            DWORD index = indices[new_to_old[i] * 3 + j];
+            if (vertex_remap_ptr[index] == -1)
+                vertex_remap_ptr[index] = num_used_vertices++;
+        }
+    }
+    if (!compact)
+    {
+        for (i = 0; i < This->numvertices; ++i)
+        {
+            if (vertex_remap_ptr[i] == -1)
+                vertex_remap_ptr[i] = num_used_vertices++;
+        }
+    }
+
+    /* convert indices */
+    for (i = 0; i < This->numfaces * 3; ++i)
+        indices[i] = vertex_remap_ptr[indices[i]];
+
+    /* create new->old vertex mapping */
+    for (i = 0; i < This->numvertices; ++i)
+        new_to_old[i] = -1;
+    for (i = 0; i < This->numvertices; ++i)
+    {
+        if (vertex_remap_ptr[i] != -1)
+            new_to_old[vertex_remap_ptr[i]] = i;
+    }
+    memcpy(vertex_remap_ptr, new_to_old, This->numvertices * sizeof(*vertex_remap_ptr));
+    HeapFree(GetProcessHeap(), 0, new_to_old);
+
+    *new_num_vertices = num_used_vertices;
+
+    return D3D_OK;
+}
+
 static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags, const DWORD *adjacency_in,
         DWORD *adjacency_out, DWORD *face_remap_out, ID3DXBuffer **vertex_remap_out)
 {
@@ -1659,7 +2064,7 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
     DWORD new_num_alloc_vertices = 0;
     IDirect3DVertexBuffer9 *vertex_buffer = NULL;
     DWORD *sorted_attrib_buffer = NULL;
-    DWORD i;
+    DWORD i, j;
 
     TRACE("iface %p, flags %#x, adjacency_in %p, adjacency_out %p, face_remap_out %p, vertex_remap_out %p.\n",
             iface, flags, adjacency_in, adjacency_out, face_remap_out, vertex_remap_out);
@@ -1671,14 +2076,9 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
     if ((flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER)) == (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
         return D3DERR_INVALIDCALL;
 
+    /* Face reordering is done within each attribute range. */
     if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
-    {
-        if (flags & D3DXMESHOPT_VERTEXCACHE)
-            FIXME("D3DXMESHOPT_VERTEXCACHE not implemented.\n");
-        if (flags & D3DXMESHOPT_STRIPREORDER)
-            FIXME("D3DXMESHOPT_STRIPREORDER not implemented.\n");
-        return E_NOTIMPL;
-    }
+        flags |= D3DXMESHOPT_ATTRSORT;
 
     hr = iface->lpVtbl->LockIndexBuffer(iface, 0, &indices);
     if (FAILED(hr)) goto cleanup;
@@ -1699,18 +2099,25 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
         hr = compact_mesh(This, dword_indices, &new_num_vertices, &vertex_remap);
         if (FAILED(hr)) goto cleanup;
     } else if (flags & D3DXMESHOPT_ATTRSORT) {
-        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
-        {
-            FIXME("D3DXMESHOPT_ATTRSORT vertex reordering not implemented.\n");
-            hr = E_NOTIMPL;
-            goto cleanup;
-        }
-
         hr = iface->lpVtbl->LockAttributeBuffer(iface, 0, &attrib_buffer);
         if (FAILED(hr)) goto cleanup;
 
         hr = remap_faces_for_attrsort(This, dword_indices, attrib_buffer, &sorted_attrib_buffer, &face_remap);
         if (FAILED(hr)) goto cleanup;
+
+        if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
+        {
+            hr = remap_faces_for_vertex_cache(This, flags, dword_indices, sorted_attrib_buffer, adjacency_in, face_remap);
+            if (FAILED(hr)) goto cleanup;
+        }
+
+        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
+        {
+            new_num_alloc_vertices = This->numvertices;
+            hr = remap_vertices_for_fetch(This, dword_indices, face_remap, flags & D3DXMESHOPT_COMPACT,
+                    &new_num_vertices, &vertex_remap);
+            if (FAILED(hr)) goto cleanup;
+        }
     }
 
     if (vertex_remap)
@@ -1803,9 +2210,11 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
             for (i = 0; i < This->numfaces; i++) {
                 DWORD old_pos = i * 3;
                 DWORD new_pos = face_remap[i] * 3;
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
-                adjacency_out[new_pos++] = face_remap[adjacency_in[old_pos++]];
+                for (j = 0; j < 3; j++) {
+                    DWORD adj = adjacency_in[old_pos++];
+                    /* Boundary edges are stored as 0xffffffff. */
+                    adjacency_out[new_pos++] = adj < This->numfaces ? face_remap[adj] : adj;
+                }
             }
         } else {
             memcpy(adjacency_out, adjacency_in, This->numfaces * 3 * sizeof(*adjacency_out));
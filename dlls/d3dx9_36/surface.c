@@ -1331,6 +1331,8 @@ struct argb_conversion_info
     DWORD srcmask[4], destmask[4];
     BOOL process_channel[4];
     DWORD channelmask;
+    /* No channel needs to be widened, so every channel is a mask and a shift. */
+    BOOL simple;
 };
 
 static void init_argb_conversion_info(const struct pixel_format_desc *srcformat, const struct pixel_format_desc *destformat, struct argb_conversion_info *info)
@@ -1338,6 +1340,7 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
     UINT i;
     ZeroMemory(info->process_channel, 4 * sizeof(BOOL));
     info->channelmask = 0;
+    info->simple = TRUE;
 
     info->srcformat  =  srcformat;
     info->destformat = destformat;
@@ -1357,6 +1360,8 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
             if(srcformat->bits[i]) info->process_channel[i] = TRUE;
             else info->channelmask |= info->destmask[i];
         }
+        if (info->process_channel[i] && destformat->bits[i] > srcformat->bits[i])
+            info->simple = FALSE;
     }
 }
 
@@ -1397,6 +1402,42 @@ static DWORD make_argb_color(const struct argb_conversion_info *info, const DWOR
     return val;
 }
 
+/************************************************************
+ * convert_argb_color
+ *
+ * Converts a color between two ARGB formats, combining
+ * get_relevant_argb_components and make_argb_color.
+ */
+static inline DWORD convert_argb_color(const struct argb_conversion_info *info, DWORD col, DWORD *channels)
+{
+    DWORD val;
+    UINT i;
+
+    if (!info->simple)
+    {
+        get_relevant_argb_components(info, col, channels);
+        return make_argb_color(info, channels);
+    }
+
+    val = info->channelmask;
+    for (i = 0; i < 4; ++i)
+    {
+        if (info->process_channel[i])
+            val |= ((col & info->srcmask[i]) >> info->srcshift[i]) << info->destshift[i];
+    }
+    return val;
+}
+
+/* Whether pixels can be copied unchanged between the two formats. */
+static BOOL is_identity_conversion(const struct pixel_format_desc *src_format,
+        const struct pixel_format_desc *dst_format, D3DCOLOR color_key)
+{
+    return src_format == dst_format && !color_key && src_format->type == FORMAT_ARGB
+            && !src_format->to_rgba && !src_format->from_rgba
+            && src_format->bits[0] + src_format->bits[1] + src_format->bits[2] + src_format->bits[3]
+            == src_format->bytes_per_pixel * 8;
+}
+
 /* It doesn't work for components bigger than 32 bits (or somewhat smaller but unaligned). */
 static void format_to_vec4(const struct pixel_format_desc *format, const BYTE *src, struct vec4 *dst)
 {
@@ -1517,6 +1558,9 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
 {
     struct argb_conversion_info conv_info, ck_conv_info;
     const struct pixel_format_desc *ck_format = NULL;
+    BOOL argb_path = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
+    BOOL identity = is_identity_conversion(src_format, dst_format, color_key);
     DWORD channels[4];
     UINT min_width, min_height, min_depth;
     UINT x, y, z;
@@ -1543,21 +1587,30 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
             const BYTE *src_ptr = src_slice_ptr + y * src_row_pitch;
             BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
 
-            for (x = 0; x < min_width; x++) {
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+            if (identity)
+            {
+                memcpy(dst_ptr, src_ptr, min_width * src_format->bytes_per_pixel);
+                src_ptr += min_width * src_format->bytes_per_pixel;
+                dst_ptr += min_width * dst_format->bytes_per_pixel;
+                x = min_width;
+            }
+            else
+            {
+                x = 0;
+            }
+
+            for (; x < min_width; x++) {
+                if (argb_path)
                 {
                     DWORD val;
 
-                    get_relevant_argb_components(&conv_info, *(DWORD *)src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
+                    val = convert_argb_color(&conv_info, *(DWORD *)src_ptr, channels);
 
                     if (color_key)
                     {
                         DWORD ck_pixel;
 
-                        get_relevant_argb_components(&ck_conv_info, *(DWORD *)src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
+                        ck_pixel = convert_argb_color(&ck_conv_info, *(DWORD *)src_ptr, channels);
                         if (ck_pixel == color_key)
                             val &= ~conv_info.destmask[0];
                     }
@@ -1620,6 +1673,9 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
 {
     struct argb_conversion_info conv_info, ck_conv_info;
     const struct pixel_format_desc *ck_format = NULL;
+    BOOL argb_path = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
+    BOOL identity = is_identity_conversion(src_format, dst_format, color_key);
     DWORD channels[4];
     UINT x, y, z;
 
@@ -1647,20 +1703,21 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
             {
                 const BYTE *src_ptr = src_row_ptr + (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
 
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                if (identity)
+                {
+                    memcpy(dst_ptr, src_ptr, dst_format->bytes_per_pixel);
+                }
+                else if (argb_path)
                 {
                     DWORD val;
 
-                    get_relevant_argb_components(&conv_info, *(DWORD *)src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
+                    val = convert_argb_color(&conv_info, *(DWORD *)src_ptr, channels);
 
                     if (color_key)
                     {
                         DWORD ck_pixel;
 
-                        get_relevant_argb_components(&ck_conv_info, *(DWORD *)src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
+                        ck_pixel = convert_argb_color(&ck_conv_info, *(DWORD *)src_ptr, channels);
                         if (ck_pixel == color_key)
                             val &= ~conv_info.destmask[0];
                     }
@@ -10288,6 +10288,145 @@ static void test_optimize_faces(void)
     "faces when using 16-bit indices. Got %x\n, expected D3DERR_INVALIDCALL\n", hr);
 }
 
+static void test_optimize_vertex_cache(void)
+{
+    static const DWORD flags[] =
+    {
+        D3DXMESHOPT_VERTEXCACHE,
+        D3DXMESHOPT_STRIPREORDER,
+        D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_IGNOREVERTS,
+        D3DXMESHOPT_STRIPREORDER | D3DXMESHOPT_IGNOREVERTS,
+    };
+    const unsigned int size = 4, num_faces = size * size * 2, num_vertices = (size + 1) * (size + 1);
+    struct test_context *test_context;
+    D3DXVECTOR3 positions[25], *vertices;
+    DWORD indices[96], adjacency[96], adjacency_out[96], face_remap[32];
+    DWORD *new_indices, *attributes;
+    ID3DXBuffer *vertex_remap;
+    ID3DXMesh *mesh;
+    unsigned int i, j, k, x, y;
+    BOOL seen[32];
+    HRESULT hr;
+
+    if (!(test_context = new_test_context()))
+    {
+        skip("Couldn't create test context.\n");
+        return;
+    }
+
+    for (y = 0; y <= size; ++y)
+    {
+        for (x = 0; x <= size; ++x)
+        {
+            positions[y * (size + 1) + x].x = x;
+            positions[y * (size + 1) + x].y = y;
+            positions[y * (size + 1) + x].z = 0.0f;
+        }
+    }
+    for (y = 0, i = 0; y < size; ++y)
+    {
+        for (x = 0; x < size; ++x, i += 6)
+        {
+            DWORD v = y * (size + 1) + x;
+
+            indices[i] = v;
+            indices[i + 1] = v + size + 1;
+            indices[i + 2] = v + 1;
+            indices[i + 3] = v + 1;
+            indices[i + 4] = v + size + 1;
+            indices[i + 5] = v + size + 2;
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(flags); ++i)
+    {
+        hr = D3DXCreateMeshFVF(num_faces, num_vertices, D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM,
+                D3DFVF_XYZ, test_context->device, &mesh);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+
+        hr = mesh->lpVtbl->LockVertexBuffer(mesh, 0, (void **)&vertices);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        memcpy(vertices, positions, sizeof(positions));
+        mesh->lpVtbl->UnlockVertexBuffer(mesh);
+        hr = mesh->lpVtbl->LockIndexBuffer(mesh, 0, (void **)&new_indices);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        memcpy(new_indices, indices, sizeof(indices));
+        mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        /* Alternate the attribute per quad. */
+        hr = mesh->lpVtbl->LockAttributeBuffer(mesh, 0, &attributes);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        for (j = 0; j < num_faces; ++j)
+            attributes[j] = (j / 2) % 2;
+        mesh->lpVtbl->UnlockAttributeBuffer(mesh);
+
+        hr = mesh->lpVtbl->GenerateAdjacency(mesh, 0.0f, adjacency);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, flags[i], NULL, NULL, NULL, NULL);
+        ok(hr == D3DERR_INVALIDCALL, "Test %u: Got unexpected hr %#x.\n", i, hr);
+
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, flags[i], adjacency, adjacency_out, face_remap, &vertex_remap);
+        ok(hr == D3D_OK, "Test %u: Got unexpected hr %#x.\n", i, hr);
+        if (FAILED(hr))
+        {
+            mesh->lpVtbl->Release(mesh);
+            continue;
+        }
+        ID3DXBuffer_Release(vertex_remap);
+
+        mesh->lpVtbl->LockVertexBuffer(mesh, D3DLOCK_READONLY, (void **)&vertices);
+        mesh->lpVtbl->LockIndexBuffer(mesh, D3DLOCK_READONLY, (void **)&new_indices);
+        mesh->lpVtbl->LockAttributeBuffer(mesh, D3DLOCK_READONLY, &attributes);
+
+        /* The faces are sorted by attribute, and each face still covers
+         * the same positions, starting at any of its corners. */
+        memset(seen, 0, sizeof(seen));
+        for (j = 0; j < num_faces; ++j)
+        {
+            DWORD old_face = face_remap[j];
+            BOOL match = FALSE;
+
+            ok(old_face < num_faces && !seen[old_face], "Test %u: Got unexpected face %u at %u.\n",
+                    i, old_face, j);
+            if (old_face >= num_faces)
+                continue;
+            seen[old_face] = TRUE;
+
+            ok(attributes[j] == (old_face / 2) % 2, "Test %u: Got unexpected attribute %u for face %u.\n",
+                    i, attributes[j], j);
+            ok(!j || attributes[j] >= attributes[j - 1], "Test %u: Attributes aren't sorted at face %u.\n", i, j);
+
+            for (k = 0; k < 3 && !match; ++k)
+            {
+                match = !memcmp(&vertices[new_indices[j * 3]], &positions[indices[old_face * 3 + k]], sizeof(*vertices))
+                        && !memcmp(&vertices[new_indices[j * 3 + 1]], &positions[indices[old_face * 3 + (k + 1) % 3]], sizeof(*vertices))
+                        && !memcmp(&vertices[new_indices[j * 3 + 2]], &positions[indices[old_face * 3 + (k + 2) % 3]], sizeof(*vertices));
+            }
+            ok(match, "Test %u: Face %u doesn't match the original face %u.\n", i, j, old_face);
+
+            /* The grid is open, so the border edges have no neighbour. */
+            for (k = 0; k < 3; ++k)
+            {
+                DWORD adj = adjacency_out[j * 3 + k];
+
+                if (adjacency[old_face * 3 + k] == 0xffffffff)
+                    ok(adj == 0xffffffff, "Test %u: Got unexpected adjacency %#x for face %u, edge %u.\n",
+                            i, adj, j, k);
+                else
+                    ok(adj < num_faces && face_remap[adj] == adjacency[old_face * 3 + k],
+                            "Test %u: Got unexpected adjacency %#x for face %u, edge %u.\n", i, adj, j, k);
+            }
+        }
+
+        mesh->lpVtbl->UnlockAttributeBuffer(mesh);
+        mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        mesh->lpVtbl->UnlockVertexBuffer(mesh);
+        mesh->lpVtbl->Release(mesh);
+    }
+
+    free_test_context(test_context);
+}
+
 START_TEST(mesh)
 {
     D3DXBoundProbeTest();
@@ -10314,4 +10453,5 @@ START_TEST(mesh)
     test_clone_mesh();
     test_valid_mesh();
     test_optimize_faces();
+    test_optimize_vertex_cache();
 }
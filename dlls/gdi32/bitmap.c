@@ -246,9 +246,10 @@ LONG WINAPI GetBitmapBits(
     struct gdi_image_bits src_bits;
     struct bitblt_coords src;
     int dst_stride, max, ret;
-    BITMAPOBJ *bmp = GDI_GetObjPtr( hbitmap, OBJ_BITMAP );
+    BITMAPOBJ *bmp;
 
-    if (!bmp) return 0;
+    GdiFlush();  /* the bitmap may have pending batched drawing */
+    if (!(bmp = GDI_GetObjPtr( hbitmap, OBJ_BITMAP ))) return 0;
 
     dst_stride = get_bitmap_stride( bmp->dib.dsBm.bmWidth, bmp->dib.dsBm.bmBitsPixel );
     ret = max = dst_stride * bmp->dib.dsBm.bmHeight;
@@ -321,6 +322,7 @@ LONG WINAPI SetBitmapBits(
 
     if (!bits) return 0;
 
+    GdiFlush();  /* the bitmap may have pending batched drawing */
     bmp = GDI_GetObjPtr( hbitmap, OBJ_BITMAP );
     if (!bmp) return 0;
 
@@ -687,6 +687,7 @@ INT WINAPI SetDIBits( HDC hdc, HBITMAP hbitmap, UINT startscan,
 
     if (coloruse == DIB_PAL_COLORS && !fill_color_table_from_pal_colors( src_info, hdc )) return 0;
 
+    GdiFlush();  /* the bitmap may have pending batched drawing */
     if (!(bitmap = GDI_GetObjPtr( hbitmap, OBJ_BITMAP ))) return 0;
 
     if (src_info->bmiHeader.biCompression == BI_RLE4 || src_info->bmiHeader.biCompression == BI_RLE8)
@@ -1223,6 +1224,7 @@ INT WINAPI GetDIBits(
     dst_info->bmiHeader.biClrUsed = 0;
     dst_info->bmiHeader.biClrImportant = 0;
 
+    GdiFlush();  /* the bitmap may have pending batched drawing */
     if (!(dc = get_dc_ptr( hdc )))
     {
         SetLastError( ERROR_INVALID_PARAMETER );
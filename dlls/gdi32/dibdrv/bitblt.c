@@ -21,8 +21,11 @@
 #include <assert.h>
 
 #include "gdi_private.h"
+#include "winternl.h"
+#include "winreg.h"
 #include "dibdrv.h"
 
+#include "wine/unicode.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
@@ -466,6 +469,184 @@ static int get_overlap( const dib_info *dst, const RECT *dst_rect,
     return ret;
 }
 
+/* Large operations can optionally be split into horizontal bands that are rendered
+ * in parallel on the thread pool.  This is disabled unless the RenderThreads value
+ * is set under HKCU\Software\Wine\Gdi. */
+
+#define MAX_BAND_THREADS 16
+#define MIN_BAND_ROWS    64
+#define MIN_BAND_PIXELS  (256 * 256)
+
+static INIT_ONCE band_init_once = INIT_ONCE_STATIC_INIT;
+static int band_threads;
+
+static BOOL CALLBACK init_band_threads( INIT_ONCE *once, void *param, void **context )
+{
+    static const WCHAR gdi_keyW[] = {'S','o','f','t','w','a','r','e','\\','W','i','n','e','\\','G','d','i',0};
+    static const WCHAR render_threadsW[] = {'R','e','n','d','e','r','T','h','r','e','a','d','s',0};
+    SYSTEM_INFO info;
+    WCHAR buffer[16];
+    DWORD type, count = sizeof(buffer);
+    HKEY key;
+    int threads = 0;
+
+    if (RegOpenKeyW( HKEY_CURRENT_USER, gdi_keyW, &key )) return TRUE;
+    if (!RegQueryValueExW( key, render_threadsW, NULL, &type, (BYTE *)buffer, &count ))
+    {
+        if (type == REG_DWORD) threads = *(DWORD *)buffer;
+        else if (type == REG_SZ) threads = atoiW( buffer );
+    }
+    RegCloseKey( key );
+
+    GetSystemInfo( &info );
+    band_threads = max( 0, min( threads, min( MAX_BAND_THREADS, (int)info.dwNumberOfProcessors )));
+    TRACE( "using %d render threads\n", band_threads );
+    return TRUE;
+}
+
+struct band_work
+{
+    band_func  func;
+    void      *ctx;
+    int        top;
+    int        rows;
+    int        bands;
+    LONG       next;      /* next band to render */
+    LONG       finished;  /* number of bands rendered */
+    LONG       refs;      /* the caller and each queued work item */
+    HANDLE     done;
+};
+
+/* render bands until none are left, returns TRUE if the last one was finished by us */
+static BOOL render_bands( struct band_work *work )
+{
+    BOOL last = FALSE;
+    int i;
+
+    while ((i = InterlockedIncrement( &work->next ) - 1) < work->bands)
+    {
+        work->func( work->ctx, work->top + work->rows * i / work->bands,
+                    work->top + work->rows * (i + 1) / work->bands );
+        last = (InterlockedIncrement( &work->finished ) == work->bands);
+    }
+    return last;
+}
+
+static void release_band_work( struct band_work *work )
+{
+    if (InterlockedDecrement( &work->refs )) return;
+    CloseHandle( work->done );
+    HeapFree( GetProcessHeap(), 0, work );
+}
+
+static DWORD CALLBACK band_thread_proc( void *arg )
+{
+    struct band_work *work = arg;
+
+    if (render_bands( work )) SetEvent( work->done );
+    release_band_work( work );
+    return 0;
+}
+
+/* threads created while the loader lock is held can't start running, so don't use them */
+static BOOL loader_lock_held(void)
+{
+    RTL_CRITICAL_SECTION *lock = NtCurrentTeb()->Peb->LoaderLock;
+
+    return lock && lock->OwningThread == ULongToHandle( GetCurrentThreadId() );
+}
+
+/***********************************************************************
+ *           run_in_bands
+ *
+ * Call func for the rows top to bottom, possibly split into several bands rendered
+ * concurrently.  func must only touch the destination rows it's given, so that the
+ * result is the same as a single call for the whole range.
+ *
+ * The calling thread renders bands too, and only waits for the ones a pool thread
+ * has already started, so it never depends on pool threads becoming available.
+ */
+void run_in_bands( band_func func, void *ctx, int top, int bottom, int width )
+{
+    struct band_work *work;
+    int i, bands, rows = bottom - top;
+
+    InitOnceExecuteOnce( &band_init_once, init_band_threads, NULL, NULL );
+
+    bands = min( band_threads, rows / MIN_BAND_ROWS );
+    if (bands < 2 || (LONGLONG)rows * width < MIN_BAND_PIXELS || loader_lock_held() ||
+        !(work = HeapAlloc( GetProcessHeap(), 0, sizeof(*work) )))
+    {
+        func( ctx, top, bottom );
+        return;
+    }
+    if (!(work->done = CreateEventW( NULL, TRUE, FALSE, NULL )))
+    {
+        HeapFree( GetProcessHeap(), 0, work );
+        func( ctx, top, bottom );
+        return;
+    }
+
+    work->func     = func;
+    work->ctx      = ctx;
+    work->top      = top;
+    work->rows     = rows;
+    work->bands    = bands;
+    work->next     = 0;
+    work->finished = 0;
+    work->refs     = 1;
+
+    for (i = 1; i < bands; i++)
+    {
+        InterlockedIncrement( &work->refs );
+        if (!QueueUserWorkItem( band_thread_proc, work, WT_EXECUTEDEFAULT ))
+        {
+            InterlockedDecrement( &work->refs );
+            break;
+        }
+    }
+
+    if (!render_bands( work ) && work->finished < bands)
+        WaitForSingleObject( work->done, INFINITE );
+    release_band_work( work );
+}
+
+/* intersect a list of rectangles with a band of rows, returns FALSE if there's nothing left */
+static BOOL get_band_rect( const RECT *rect, int top, int bottom, RECT *ret )
+{
+    *ret = *rect;
+    ret->top = max( rect->top, top );
+    ret->bottom = min( rect->bottom, bottom );
+    return ret->top < ret->bottom;
+}
+
+struct copy_rect_band
+{
+    dib_info       *dst;
+    const RECT     *dst_rect;
+    const dib_info *src;
+    const RECT     *src_rect;
+    const RECT     *rects;
+    int             count;
+    INT             rop2;
+};
+
+static void copy_rect_band( void *arg, int top, int bottom )
+{
+    struct copy_rect_band *ctx = arg;
+    POINT origin;
+    RECT rect;
+    int i;
+
+    for (i = 0; i < ctx->count; i++)
+    {
+        if (!get_band_rect( &ctx->rects[i], top, bottom, &rect )) continue;
+        origin.x = ctx->src_rect->left + rect.left - ctx->dst_rect->left;
+        origin.y = ctx->src_rect->top  + rect.top  - ctx->dst_rect->top;
+        ctx->dst->funcs->copy_rect( ctx->dst, &rect, ctx->src, &origin, ctx->rop2, 0 );
+    }
+}
+
 static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                         const struct clipped_rects *clipped_rects, INT rop2 )
 {
@@ -541,7 +722,7 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
             }
         }
     }
-    else  /* left to right, top to bottom */
+    else if (overlap)  /* left to right, top to bottom */
     {
         for (i = 0; i < count; i++)
         {
@@ -550,22 +731,48 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
             dst->funcs->copy_rect( dst, &rects[i], src, &origin, rop2, overlap );
         }
     }
+    else  /* no overlap, rows can be copied in any order */
+    {
+        struct copy_rect_band ctx = { dst, dst_rect, src, src_rect, rects, count, rop2 };
+        run_in_bands( copy_rect_band, &ctx, dst_rect->top, dst_rect->bottom,
+                      dst_rect->right - dst_rect->left );
+    }
 }
 
-static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
-                         HRGN clip, BLENDFUNCTION blend )
+struct blend_rect_band
 {
+    dib_info                   *dst;
+    const RECT                 *dst_rect;
+    const dib_info             *src;
+    const RECT                 *src_rect;
+    const struct clipped_rects *clipped_rects;
+    BLENDFUNCTION               blend;
+};
+
+static void blend_rect_band( void *arg, int top, int bottom )
+{
+    struct blend_rect_band *ctx = arg;
     POINT origin;
-    struct clipped_rects clipped_rects;
+    RECT rect;
     int i;
 
-    if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
-    for (i = 0; i < clipped_rects.count; i++)
+    for (i = 0; i < ctx->clipped_rects->count; i++)
     {
-        origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
-        origin.y = src_rect->top  + clipped_rects.rects[i].top  - dst_rect->top;
-        dst->funcs->blend_rect( dst, &clipped_rects.rects[i], src, &origin, blend );
+        if (!get_band_rect( &ctx->clipped_rects->rects[i], top, bottom, &rect )) continue;
+        origin.x = ctx->src_rect->left + rect.left - ctx->dst_rect->left;
+        origin.y = ctx->src_rect->top  + rect.top  - ctx->dst_rect->top;
+        ctx->dst->funcs->blend_rect( ctx->dst, &rect, ctx->src, &origin, ctx->blend );
     }
+}
+
+static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
+                         HRGN clip, BLENDFUNCTION blend )
+{
+    struct clipped_rects clipped_rects;
+    struct blend_rect_band ctx = { dst, dst_rect, src, src_rect, &clipped_rects, blend };
+
+    if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
+    run_in_bands( blend_rect_band, &ctx, dst_rect->top, dst_rect->bottom, dst_rect->right - dst_rect->left );
     free_clipped_rects( &clipped_rects );
     return ERROR_SUCCESS;
 }
@@ -649,19 +856,38 @@ static void get_gradient_triangle_vertices( const GRADIENT_TRIANGLE *tri, const
     bounds->bottom = v[2].y;
 }
 
-static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
+struct gradient_rect_band
+{
+    dib_info                   *dib;
+    TRIVERTEX                  *v;
+    int                         mode;
+    const struct clipped_rects *clipped_rects;
+    LONG                        ret;
+};
+
+static void gradient_rect_band( void *arg, int top, int bottom )
 {
+    struct gradient_rect_band *ctx = arg;
+    RECT rect;
     int i;
-    struct clipped_rects clipped_rects;
-    BOOL ret = TRUE;
 
-    if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
-    for (i = 0; i < clipped_rects.count; i++)
+    for (i = 0; i < ctx->clipped_rects->count && ctx->ret; i++)
     {
-        if (!(ret = dib->funcs->gradient_rect( dib, &clipped_rects.rects[i], v, mode ))) break;
+        if (!get_band_rect( &ctx->clipped_rects->rects[i], top, bottom, &rect )) continue;
+        if (!ctx->dib->funcs->gradient_rect( ctx->dib, &rect, ctx->v, ctx->mode ))
+            InterlockedExchange( &ctx->ret, FALSE );
     }
+}
+
+static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
+{
+    struct clipped_rects clipped_rects;
+    struct gradient_rect_band ctx = { dib, v, mode, &clipped_rects, TRUE };
+
+    if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
+    run_in_bands( gradient_rect_band, &ctx, bounds->top, bounds->bottom, bounds->right - bounds->left );
     free_clipped_rects( &clipped_rects );
-    return ret;
+    return ctx.ret;
 }
 
 static DWORD copy_src_bits( dib_info *src, RECT *src_rect )
@@ -854,6 +1080,7 @@ DWORD dibdrv_GetImage( PHYSDEV dev, BITMAPINFO *info, struct gdi_image_bits *bit
     dibdrv_physdev *pdev = get_dibdrv_pdev(dev);
 
     TRACE( "%p %p\n", dev, info );
+    flush_fill_batch( pdev );
 
     return get_image_dib_info( &pdev->dib, info, bits, src );
 }
@@ -955,6 +1182,7 @@ DWORD dibdrv_PutImage( PHYSDEV dev, HRGN clip, BITMAPINFO *info,
     dibdrv_physdev *pdev = get_dibdrv_pdev( dev );
 
     TRACE( "%p %p\n", dev, info );
+    flush_fill_batch( pdev );
 
     if (!matching_color_info( &pdev->dib, info )) goto update_format;
     if (!bits) return ERROR_SUCCESS;
@@ -1003,6 +1231,7 @@ DWORD dibdrv_BlendImage( PHYSDEV dev, BITMAPINFO *info, const struct gdi_image_b
     DWORD *masks = (DWORD *)info->bmiColors;
 
     TRACE( "%p %p\n", dev, info );
+    flush_fill_batch( pdev );
 
     if (info->bmiHeader.biPlanes != 1) goto update_format;
     if (info->bmiHeader.biBitCount != 32) goto update_format;
@@ -1389,6 +1618,8 @@ BOOL dibdrv_GradientFill( PHYSDEV dev, TRIVERTEX *vert_array, ULONG nvert,
     RECT bounds;
     BOOL ret = TRUE;
 
+    flush_fill_batch( pdev );
+
     if (!(pts = HeapAlloc( GetProcessHeap(), 0, nvert * sizeof(*pts) ))) return FALSE;
     for (i = 0; i < nvert; i++)
     {
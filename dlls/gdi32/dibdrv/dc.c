@@ -213,28 +213,50 @@ void copy_dib_color_info(dib_info *dst, const dib_info *src)
     dst->color_table      = src->color_table;
 }
 
-DWORD convert_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
-                          const BITMAPINFO *dst_info, void *dst_bits )
+struct convert_band
 {
-    dib_info src_dib, dst_dib;
-    DWORD ret;
+    const dib_info *dst;
+    const dib_info *src;
+    const RECT     *src_rect;
+    void           *src_bits;
+    LONG            ret;
+};
 
-    init_dib_info_from_bitmapinfo( &src_dib, src_info, src_bits );
-    init_dib_info_from_bitmapinfo( &dst_dib, dst_info, dst_bits );
+static void convert_band( void *arg, int top, int bottom )
+{
+    struct convert_band *ctx = arg;
+    dib_info dst = *ctx->dst;
+    RECT rect = *ctx->src_rect;
+
+    /* the destination rows are stored starting at 0 */
+    dst.rect.top += top - rect.top;
+    rect.top = top;
+    rect.bottom = bottom;
 
     __TRY
     {
-        dst_dib.funcs->convert_to( &dst_dib, &src_dib, &src->visrect, FALSE );
-        ret = TRUE;
+        dst.funcs->convert_to( &dst, ctx->src, &rect, FALSE );
     }
     __EXCEPT_PAGE_FAULT
     {
-        WARN( "invalid bits pointer %p\n", src_bits );
-        ret = FALSE;
+        WARN( "invalid bits pointer %p\n", ctx->src_bits );
+        InterlockedExchange( &ctx->ret, FALSE );
     }
     __ENDTRY
+}
+
+DWORD convert_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
+                          const BITMAPINFO *dst_info, void *dst_bits )
+{
+    dib_info src_dib, dst_dib;
+    struct convert_band ctx = { &dst_dib, &src_dib, &src->visrect, src_bits, TRUE };
+
+    init_dib_info_from_bitmapinfo( &src_dib, src_info, src_bits );
+    init_dib_info_from_bitmapinfo( &dst_dib, dst_info, dst_bits );
 
-    if(!ret) return ERROR_BAD_FORMAT;
+    run_in_bands( convert_band, &ctx, src->visrect.top, src->visrect.bottom,
+                  src->visrect.right - src->visrect.left );
+    if (!ctx.ret) return ERROR_BAD_FORMAT;
 
     /* update coordinates, the destination rectangle is always stored at 0,0 */
     src->x -= src->visrect.left;
@@ -279,7 +301,7 @@ int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct cl
 
     if (!(region = get_wine_region( clip ))) return 0;
 
-    for (i = 0; i < region->numRects; i++)
+    for (i = find_region_band( region, rect.top ); i < region->numRects; i++)
     {
         if (region->rects[i].top >= rect.bottom) break;
         if (!intersect_rect( out, &rect, &region->rects[i] )) continue;
@@ -340,6 +362,8 @@ static BOOL dibdrv_DeleteDC( PHYSDEV dev )
 {
     dibdrv_physdev *pdev = get_dibdrv_pdev(dev);
     TRACE("(%p)\n", dev);
+    flush_fill_batch( pdev );
+    HeapFree( GetProcessHeap(), 0, pdev->batch.rects );
     free_pattern_brush( &pdev->brush );
     free_pattern_brush( &pdev->pen_brush );
     release_cached_font( pdev->font );
@@ -353,12 +377,13 @@ static BOOL dibdrv_DeleteDC( PHYSDEV dev )
 static HBITMAP dibdrv_SelectBitmap( PHYSDEV dev, HBITMAP bitmap )
 {
     dibdrv_physdev *pdev = get_dibdrv_pdev(dev);
-    BITMAPOBJ *bmp = GDI_GetObjPtr( bitmap, OBJ_BITMAP );
+    BITMAPOBJ *bmp;
     dib_info dib;
 
     TRACE("(%p, %p)\n", dev, bitmap);
 
-    if (!bmp) return 0;
+    flush_fill_batch( pdev );
+    if (!(bmp = GDI_GetObjPtr( bitmap, OBJ_BITMAP ))) return 0;
 
     if (!init_dib_info_from_bitmapobj(&dib, bmp))
     {
@@ -366,6 +391,7 @@ static HBITMAP dibdrv_SelectBitmap( PHYSDEV dev, HBITMAP bitmap )
         return 0;
     }
     pdev->dib = dib;
+    pdev->batch.enabled = TRUE;
     GDI_ReleaseObj( bitmap );
 
     return bitmap;
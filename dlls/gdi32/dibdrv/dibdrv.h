@@ -85,6 +85,18 @@ struct intensity_range
     BYTE b_min, b_max;
 };
 
+/* solid fills queued by PatBlt while the batch limit is larger than 1 */
+struct fill_batch
+{
+    struct list entry;     /* entry in the list of pending batches */
+    BOOL        enabled;   /* only memory DCs can batch */
+    DWORD       thread;    /* thread that queued the fills */
+    DWORD       calls;     /* number of PatBlt calls in the batch */
+    DWORD       and, xor;
+    int         count, size;
+    RECT       *rects;
+};
+
 typedef struct dibdrv_physdev
 {
     struct gdi_physdev dev;
@@ -104,6 +116,8 @@ typedef struct dibdrv_physdev
     dash_pos dash_pos;
     rop_mask dash_masks[2];
     BOOL   (* pen_lines)(struct dibdrv_physdev *pdev, int num, POINT *pts, BOOL close, HRGN region);
+
+    struct fill_batch batch;
 } dibdrv_physdev;
 
 extern BOOL     dibdrv_AlphaBlend( PHYSDEV dst_dev, struct bitblt_coords *dst,
@@ -237,6 +251,8 @@ struct clipped_rects
     RECT  buffer[32];
 };
 
+typedef void (*band_func)( void *ctx, int top, int bottom );
+
 extern void get_rop_codes(INT rop, struct rop_codes *codes) DECLSPEC_HIDDEN;
 extern void reset_dash_origin(dibdrv_physdev *pdev) DECLSPEC_HIDDEN;
 extern void init_dib_info_from_bitmapinfo(dib_info *dib, const BITMAPINFO *info, void *bits) DECLSPEC_HIDDEN;
@@ -247,11 +263,15 @@ extern void copy_dib_color_info(dib_info *dst, const dib_info *src) DECLSPEC_HID
 extern BOOL convert_dib(dib_info *dst, const dib_info *src) DECLSPEC_HIDDEN;
 extern DWORD get_pixel_color( HDC hdc, const dib_info *dib, COLORREF color, BOOL mono_fixup ) DECLSPEC_HIDDEN;
 extern int clip_rect_to_dib( const dib_info *dib, RECT *rc ) DECLSPEC_HIDDEN;
+extern void run_in_bands( band_func func, void *ctx, int top, int bottom, int width ) DECLSPEC_HIDDEN;
 extern int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct clipped_rects *clip_rects ) DECLSPEC_HIDDEN;
 extern void add_clipped_bounds( dibdrv_physdev *dev, const RECT *rect, HRGN clip ) DECLSPEC_HIDDEN;
 extern int clip_line(const POINT *start, const POINT *end, const RECT *clip,
                      const bres_params *params, POINT *pt1, POINT *pt2) DECLSPEC_HIDDEN;
 extern void release_cached_font( struct cached_font *font ) DECLSPEC_HIDDEN;
+extern BOOL get_solid_brush_masks( dibdrv_physdev *pdev, dib_brush *brush, INT rop,
+                                   DWORD *and, DWORD *xor ) DECLSPEC_HIDDEN;
+extern void execute_fill_batch( dibdrv_physdev *pdev ) DECLSPEC_HIDDEN;
 
 static inline void init_clipped_rects( struct clipped_rects *clip_rects )
 {
@@ -264,6 +284,12 @@ static inline void free_clipped_rects( struct clipped_rects *clip_rects )
     if (clip_rects->rects != clip_rects->buffer) HeapFree( GetProcessHeap(), 0, clip_rects->rects );
 }
 
+/* must be called before anything reads or writes the bits of the device */
+static inline void flush_fill_batch( dibdrv_physdev *pdev )
+{
+    if (pdev->batch.calls) execute_fill_batch( pdev );
+}
+
 /* compute the x coordinate corresponding to y on the specified edge */
 static inline int edge_coord( int y, int x1, int y1, int x2, int y2 )
 {
@@ -42,6 +42,8 @@ enum glyph_type
 
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
+#define GLYPH_CACHE_MAX_SIZE   (8 * 1024 * 1024)  /* total size of the cached glyphs */
+#define MAX_UNUSED_FONTS       64
 
 struct cached_font
 {
@@ -51,10 +53,12 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    LONG                  size;  /* total size of the cached glyphs */
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static LONG font_cache_size;
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -322,6 +326,8 @@ static BOOL draw_arc( PHYSDEV dev, INT left, INT top, INT right, INT bottom,
     BOOL ret = TRUE;
     HRGN outline = 0, interior = 0;
 
+    flush_fill_batch( pdev );
+
     if (!get_pen_device_rect( pdev, &rect, left, top, right, bottom )) return TRUE;
 
     width = rect.right - rect.left;
@@ -482,10 +488,50 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+/* must be called with the font_cache_cs held, on a font that is no longer referenced */
+static void free_cached_font( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+        }
+    }
+    InterlockedExchangeAdd( &font_cache_size, -font->size );
+    list_remove( &font->entry );
+    HeapFree( GetProcessHeap(), 0, font );
+}
+
+/* must be called with the font_cache_cs held */
+static void trim_font_cache(void)
+{
+    struct cached_font *ptr, *next;
+    UINT unused = 0;
+
+    LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
+        if (!ptr->ref) unused++;
+
+    /* the list is kept in most-recently used order, evict the least recently used unreferenced
+     * fonts until both the number of fonts and the total size of their glyphs are within bounds */
+    LIST_FOR_EACH_ENTRY_SAFE_REV( ptr, next, &font_cache, struct cached_font, entry )
+    {
+        if (unused < MAX_UNUSED_FONTS && font_cache_size <= GLYPH_CACHE_MAX_SIZE) break;
+        if (ptr->ref) continue;
+        TRACE( "evicting %p, %d bytes\n", ptr, ptr->size );
+        free_cached_font( ptr );
+        unused--;
+    }
+}
+
 static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    struct cached_font font, *ptr;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     GetTransform( hdc, 0x204, &font.xform );
@@ -509,29 +555,11 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
             list_remove( &ptr->entry );
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
-    {
-        ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
-        list_remove( &ptr->entry );
-    }
-    else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
+    trim_font_cache();
+
+    if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
     {
         LeaveCriticalSection( &font_cache_cs );
         return NULL;
@@ -539,6 +567,7 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->size = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -552,14 +581,31 @@ void release_cached_font( struct cached_font *font )
     if (font) InterlockedDecrement( &font->ref );
 }
 
+/* Add a glyph to the font, or return it in *uncached if the cache is full and
+ * the caller has to free it once it's done with it. */
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, DWORD size,
+                                              struct cached_glyph **uncached )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
     UINT page = index / GLYPH_CACHE_PAGE_SIZE;
     UINT entry = index % GLYPH_CACHE_PAGE_SIZE;
 
+    if (font_cache_size + size + GLYPH_CACHE_PAGE_SIZE * sizeof(glyph) > GLYPH_CACHE_MAX_SIZE)
+    {
+        EnterCriticalSection( &font_cache_cs );
+        trim_font_cache();
+        LeaveCriticalSection( &font_cache_cs );
+
+        /* the glyphs of fonts in use can't be freed, so stop caching instead */
+        if (font_cache_size + size + GLYPH_CACHE_PAGE_SIZE * sizeof(glyph) > GLYPH_CACHE_MAX_SIZE)
+        {
+            *uncached = glyph;
+            return glyph;
+        }
+    }
+
     if (!font->glyphs[type][page])
     {
         struct cached_glyph **ptr;
@@ -572,9 +618,19 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
         }
         if (InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page], ptr, NULL ))
             HeapFree( GetProcessHeap(), 0, ptr );
+        else
+        {
+            InterlockedExchangeAdd( &font->size, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
+            InterlockedExchangeAdd( &font_cache_size, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
+        }
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        ret = glyph;
+        InterlockedExchangeAdd( &font->size, size );
+        InterlockedExchangeAdd( &font_cache_size, size );
+    }
     else HeapFree( GetProcessHeap(), 0, glyph );
     return ret;
 }
@@ -673,7 +729,8 @@ static const int padding[4] = {0, 3, 2, 1};
  * For non-antialiased bitmaps convert them to the 17-level format
  * using only values 0 or 16.
  */
-static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *font, UINT index, UINT flags )
+static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *font, UINT index, UINT flags,
+                                                struct cached_glyph **uncached )
 {
     UINT ggo_flags = font->aa_flags;
     static const MAT2 identity = { {0,1}, {0,0}, {0,0}, {0,1} };
@@ -733,7 +790,7 @@ static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *fon
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    return add_cached_glyph( font, index, flags, glyph, FIELD_OFFSET( struct cached_glyph, bits[size] ), uncached );
 }
 
 static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT x, INT y,
@@ -741,7 +798,7 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
                            const struct clipped_rects *clipped_rects, RECT *bounds )
 {
     UINT i;
-    struct cached_glyph *glyph;
+    struct cached_glyph *glyph, *uncached;
     dib_info glyph_dib;
     DWORD text_color;
     struct intensity_range ranges[17];
@@ -759,8 +816,9 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
 
     for (i = 0; i < count; i++)
     {
+        uncached = NULL;
         if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( hdc, font, str[i], flags ))) continue;
+            !(glyph = cache_glyph_bitmap( hdc, font, str[i], flags, &uncached ))) continue;
 
         glyph_dib.width       = glyph->metrics.gmBlackBoxX;
         glyph_dib.height      = glyph->metrics.gmBlackBoxY;
@@ -786,6 +844,7 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
             x += glyph->metrics.gmCellIncX;
             y += glyph->metrics.gmCellIncY;
         }
+        HeapFree( GetProcessHeap(), 0, uncached );
     }
 }
 
@@ -828,6 +887,8 @@ BOOL dibdrv_ExtTextOut( PHYSDEV dev, INT x, INT y, UINT flags,
     struct clipped_rects clipped_rects;
     RECT bounds;
 
+    flush_fill_batch( pdev );
+
     if (!pdev->font) return FALSE;
 
     init_clipped_rects( &clipped_rects );
@@ -981,6 +1042,7 @@ BOOL dibdrv_ExtFloodFill( PHYSDEV dev, INT x, INT y, COLORREF color, UINT type )
     HRGN rgn;
 
     TRACE( "(%p, %d, %d, %08x, %d)\n", pdev, x, y, color, type );
+    flush_fill_batch( pdev );
 
     if (!is_interior( &pdev->dib, pdev->clip, x, y, pixel, type )) return FALSE;
 
@@ -1023,6 +1085,7 @@ COLORREF dibdrv_GetPixel( PHYSDEV dev, INT x, INT y )
     DWORD pixel;
 
     TRACE( "(%p, %d, %d)\n", dev, x, y );
+    flush_fill_batch( pdev );
 
     pt.x = x;
     pt.y = y;
@@ -1046,6 +1109,8 @@ BOOL dibdrv_LineTo( PHYSDEV dev, INT x, INT y )
     HRGN region = 0;
     BOOL ret;
 
+    flush_fill_batch( pdev );
+
     GetCurrentPositionEx(dev->hdc, pts);
     pts[1].x = x;
     pts[1].y = y;
@@ -1078,6 +1143,133 @@ static inline INT get_rop2_from_rop(INT rop)
     return (((rop >> 18) & 0x0c) | ((rop >> 16) & 0x03)) + 1;
 }
 
+static struct list pending_batches = LIST_INIT( pending_batches );
+
+static CRITICAL_SECTION batch_cs;
+static CRITICAL_SECTION_DEBUG batch_cs_debug =
+{
+    0, 0, &batch_cs,
+    { &batch_cs_debug.ProcessLocksList, &batch_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": batch_cs") }
+};
+static CRITICAL_SECTION batch_cs = { &batch_cs_debug, -1, 0, 0, 0, 0 };
+
+/***********************************************************************
+ *           execute_fill_batch
+ */
+void execute_fill_batch( dibdrv_physdev *pdev )
+{
+    struct fill_batch *batch = &pdev->batch;
+
+    TRACE( "%p: %u calls, %d rects\n", pdev, batch->calls, batch->count );
+
+    pdev->dib.funcs->solid_rects( &pdev->dib, batch->count, batch->rects, batch->and, batch->xor );
+    batch->calls = 0;
+    batch->count = 0;
+
+    EnterCriticalSection( &batch_cs );
+    list_remove( &batch->entry );
+    LeaveCriticalSection( &batch_cs );
+}
+
+/***********************************************************************
+ *           batch_fill_rects
+ *
+ * Queue a solid fill instead of executing it, merging it with the previous
+ * rectangle when they are adjacent. Fails if batching isn't possible.
+ */
+static BOOL batch_fill_rects( dibdrv_physdev *pdev, const struct clipped_rects *clipped_rects,
+                              DWORD and, DWORD xor )
+{
+    struct fill_batch *batch = &pdev->batch;
+    DWORD limit;
+    RECT *last;
+    int i;
+
+    if (!batch->enabled || (limit = GdiGetBatchLimit()) <= 1) return FALSE;
+
+    if (batch->calls && (batch->and != and || batch->xor != xor)) execute_fill_batch( pdev );
+
+    if (batch->count + clipped_rects->count > batch->size)
+    {
+        int size = max( batch->size * 2, batch->count + clipped_rects->count );
+        RECT *rects;
+
+        if (batch->rects)
+            rects = HeapReAlloc( GetProcessHeap(), 0, batch->rects, size * sizeof(*rects) );
+        else
+            rects = HeapAlloc( GetProcessHeap(), 0, size * sizeof(*rects) );
+        if (!rects) return FALSE;
+        batch->rects = rects;
+        batch->size = size;
+    }
+
+    for (i = 0; i < clipped_rects->count; i++)
+    {
+        const RECT *rc = &clipped_rects->rects[i];
+
+        /* the rectangles don't overlap, so adjacent ones can simply be joined */
+        last = batch->count ? &batch->rects[batch->count - 1] : NULL;
+        if (last && last->top == rc->top && last->bottom == rc->bottom && last->right == rc->left)
+            last->right = rc->right;
+        else if (last && last->left == rc->left && last->right == rc->right && last->bottom == rc->top)
+            last->bottom = rc->bottom;
+        else
+            batch->rects[batch->count++] = *rc;
+    }
+
+    batch->thread = GetCurrentThreadId();
+    if (!batch->calls++)
+    {
+        batch->and = and;
+        batch->xor = xor;
+        EnterCriticalSection( &batch_cs );
+        list_add_tail( &pending_batches, &batch->entry );
+        LeaveCriticalSection( &batch_cs );
+    }
+    if (batch->calls >= limit) execute_fill_batch( pdev );
+    return TRUE;
+}
+
+/***********************************************************************
+ *           dibdrv_flush_batches
+ *
+ * Execute the fills queued by the current thread, for GdiFlush.
+ */
+void dibdrv_flush_batches(void)
+{
+    struct fill_batch *batch;
+    DWORD thread = GetCurrentThreadId();
+    HDC *hdcs = NULL;
+    int i, count = 0;
+
+    if (list_empty( &pending_batches )) return;
+
+    EnterCriticalSection( &batch_cs );
+    LIST_FOR_EACH_ENTRY( batch, &pending_batches, struct fill_batch, entry )
+        if (batch->thread == thread) count++;
+    if (count && (hdcs = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*hdcs) )))
+    {
+        count = 0;
+        LIST_FOR_EACH_ENTRY( batch, &pending_batches, struct fill_batch, entry )
+            if (batch->thread == thread)
+                hdcs[count++] = CONTAINING_RECORD( batch, dibdrv_physdev, batch )->dev.hdc;
+    }
+    LeaveCriticalSection( &batch_cs );
+
+    if (!hdcs) return;
+    for (i = 0; i < count; i++)
+    {
+        DC *dc = get_dc_ptr( hdcs[i] );
+        PHYSDEV dev;
+
+        if (!dc) continue;
+        if ((dev = find_dc_driver( dc, &dib_driver ))) flush_fill_batch( get_dibdrv_pdev( dev ));
+        release_dc_ptr( dc );
+    }
+    HeapFree( GetProcessHeap(), 0, hdcs );
+}
+
 /***********************************************************************
  *           dibdrv_PatBlt
  */
@@ -1102,13 +1294,22 @@ BOOL dibdrv_PatBlt( PHYSDEV dev, struct bitblt_coords *dst, DWORD rop )
     case R2_WHITE: xor = ~0u;
         /* fall through */
     case R2_BLACK:
-        pdev->dib.funcs->solid_rects( &pdev->dib, clipped_rects.count, clipped_rects.rects, and, xor );
-        /* fall through */
-    case R2_NOP:
         break;
+    case R2_NOP:
+        free_clipped_rects( &clipped_rects );
+        return TRUE;
     default:
+        if (get_solid_brush_masks( pdev, brush, rop2, &and, &xor )) break;
+        flush_fill_batch( pdev );
         ret = brush->rects( pdev, brush, &pdev->dib, clipped_rects.count, clipped_rects.rects, rop2 );
-        break;
+        free_clipped_rects( &clipped_rects );
+        return ret;
+    }
+
+    if (!batch_fill_rects( pdev, &clipped_rects, and, xor ))
+    {
+        flush_fill_batch( pdev );
+        pdev->dib.funcs->solid_rects( &pdev->dib, clipped_rects.count, clipped_rects.rects, and, xor );
     }
     free_clipped_rects( &clipped_rects );
     return ret;
@@ -1125,6 +1326,7 @@ BOOL dibdrv_PaintRgn( PHYSDEV dev, HRGN rgn )
     RECT rect, bounds;
 
     TRACE("%p, %p\n", dev, rgn);
+    flush_fill_batch( pdev );
 
     reset_bounds( &bounds );
 
@@ -1155,6 +1357,8 @@ BOOL dibdrv_PolyPolygon( PHYSDEV dev, const POINT *pt, const INT *counts, DWORD
     POINT *points;
     HRGN outline = 0, interior = 0;
 
+    flush_fill_batch( pdev );
+
     for (i = total = 0; i < polygons; i++)
     {
         if (counts[i] < 2) return FALSE;
@@ -1217,6 +1421,8 @@ BOOL dibdrv_PolyPolyline( PHYSDEV dev, const POINT* pt, const DWORD* counts, DWO
     BOOL ret = TRUE;
     HRGN outline = 0;
 
+    flush_fill_batch( pdev );
+
     for (i = total = 0; i < polylines; i++)
     {
         if (counts[i] < 2) return FALSE;
@@ -1285,6 +1491,7 @@ BOOL dibdrv_Rectangle( PHYSDEV dev, INT left, INT top, INT right, INT bottom )
     HRGN outline = 0;
 
     TRACE("(%p, %d, %d, %d, %d)\n", dev, left, top, right, bottom);
+    flush_fill_batch( pdev );
 
     if (GetGraphicsMode( dev->hdc ) == GM_ADVANCED)
     {
@@ -1360,6 +1567,8 @@ BOOL dibdrv_RoundRect( PHYSDEV dev, INT left, INT top, INT right, INT bottom,
     BOOL ret = TRUE;
     HRGN outline = 0, interior = 0;
 
+    flush_fill_batch( pdev );
+
     if (!get_pen_device_rect( pdev, &rect, left, top, right, bottom )) return TRUE;
 
     pt[0].x = pt[0].y = 0;
@@ -1480,6 +1689,7 @@ COLORREF dibdrv_SetPixel( PHYSDEV dev, INT x, INT y, COLORREF color )
     DWORD pixel;
 
     TRACE( "(%p, %d, %d, %08x)\n", dev, x, y, color );
+    flush_fill_batch( pdev );
 
     pt.x = x;
     pt.y = y;
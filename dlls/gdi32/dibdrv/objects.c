@@ -1767,6 +1767,18 @@ static BOOL solid_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
     return TRUE;
 }
 
+/* retrieve the and/xor masks that a solid brush would use, fails for other brush styles */
+BOOL get_solid_brush_masks( dibdrv_physdev *pdev, dib_brush *brush, INT rop, DWORD *and, DWORD *xor )
+{
+    rop_mask brush_color;
+
+    if (brush->rects != solid_brush) return FALSE;
+    calc_rop_masks( rop, get_pixel_color( pdev->dev.hdc, &pdev->dib, brush->colorref, TRUE ), &brush_color );
+    *and = brush_color.and;
+    *xor = brush_color.xor;
+    return TRUE;
+}
+
 static BOOL alloc_brush_mask_bits( dib_brush *brush )
 {
     DWORD size = brush->dib.height * abs(brush->dib.stride);
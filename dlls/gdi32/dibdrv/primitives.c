@@ -19,6 +19,9 @@
  */
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "gdi_private.h"
 #include "dibdrv.h"
@@ -147,8 +150,37 @@ static inline void do_rop_codes_mask_8(BYTE *dst, BYTE src, struct rop_codes *co
     do_rop_mask_8( dst, (src & codes->a1) ^ codes->a2, (src & codes->x1) ^ codes->x2, mask );
 }
 
+static inline void do_rop_line_32(DWORD *ptr, DWORD and, DWORD xor, int len)
+{
+#ifdef __SSE2__
+    const __m128i and_val = _mm_set1_epi32( and ), xor_val = _mm_set1_epi32( xor );
+
+    for (; len >= 4; len -= 4, ptr += 4)
+    {
+        __m128i val = _mm_loadu_si128( (__m128i *)ptr );
+        _mm_storeu_si128( (__m128i *)ptr, _mm_xor_si128( _mm_and_si128( val, and_val ), xor_val ));
+    }
+#endif
+    for (; len > 0; len--) do_rop_32( ptr++, and, xor );
+}
+
 static inline void do_rop_codes_line_32(DWORD *dst, const DWORD *src, struct rop_codes *codes, int len)
 {
+#ifdef __SSE2__
+    /* the source is loaded before the destination is stored, so this is safe
+     * for overlapping lines as long as the destination is left of the source */
+    const __m128i a1 = _mm_set1_epi32( codes->a1 ), a2 = _mm_set1_epi32( codes->a2 );
+    const __m128i x1 = _mm_set1_epi32( codes->x1 ), x2 = _mm_set1_epi32( codes->x2 );
+
+    for (; len >= 4; len -= 4, src += 4, dst += 4)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)src );
+        __m128i and = _mm_xor_si128( _mm_and_si128( val, a1 ), a2 );
+        __m128i xor = _mm_xor_si128( _mm_and_si128( val, x1 ), x2 );
+        val = _mm_loadu_si128( (__m128i *)dst );
+        _mm_storeu_si128( (__m128i *)dst, _mm_xor_si128( _mm_and_si128( val, and ), xor ));
+    }
+#endif
     for (; len > 0; len--, src++, dst++) do_rop_codes_32( dst, *src, codes );
 }
 
@@ -282,8 +314,8 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -292,8 +324,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_line_32( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -4182,6 +4213,74 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef __SSE2__
+
+/* (val + 127) / 255 on 16-bit lanes, exact for val <= 255 * 255 */
+static inline __m128i div255_round_sse2( __m128i val )
+{
+    val = _mm_add_epi16( val, _mm_set1_epi16( 127 ));
+    val = _mm_add_epi16( val, _mm_add_epi16( _mm_srli_epi16( val, 8 ), _mm_set1_epi16( 1 )));
+    return _mm_srli_epi16( val, 8 );
+}
+
+/* same as blend_argb for two pixels unpacked to 16-bit lanes */
+static inline __m128i blend_argb_sse2( __m128i dst, __m128i src )
+{
+    __m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( src, 0xff ), 0xff );
+    __m128i inv_alpha = _mm_sub_epi16( _mm_set1_epi16( 255 ), alpha );
+    return _mm_add_epi16( src, div255_round_sse2( _mm_mullo_epi16( dst, inv_alpha )));
+}
+
+/* same as blend_color for all the channels of two pixels unpacked to 16-bit lanes */
+static inline __m128i blend_color_sse2( __m128i dst, __m128i src, __m128i alpha, __m128i inv_alpha )
+{
+    return div255_round_sse2( _mm_add_epi16( _mm_mullo_epi16( src, alpha ),
+                                             _mm_mullo_epi16( dst, inv_alpha )));
+}
+
+/* blend a row of pixels four at a time, return the number of pixels done */
+static int blend_row_8888_sse2( DWORD *dst, const DWORD *src, int len, BLENDFUNCTION blend,
+                                BOOL use_src_alpha )
+{
+    const __m128i zero = _mm_setzero_si128(), max = _mm_set1_epi16( 255 );
+    const __m128i alpha = _mm_set1_epi16( blend.SourceConstantAlpha );
+    const __m128i inv_alpha = _mm_set1_epi16( 255 - blend.SourceConstantAlpha );
+    const __m128i alpha_mask = _mm_set1_epi32( use_src_alpha ? 0 : 0xff000000 );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_or_si128( _mm_loadu_si128( (const __m128i *)(src + x) ), alpha_mask );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        __m128i s_lo = _mm_unpacklo_epi8( s, zero ), s_hi = _mm_unpackhi_epi8( s, zero );
+        __m128i d_lo = _mm_unpacklo_epi8( d, zero ), d_hi = _mm_unpackhi_epi8( d, zero );
+
+        if (!(blend.AlphaFormat & AC_SRC_ALPHA))
+        {
+            d_lo = blend_color_sse2( d_lo, s_lo, alpha, inv_alpha );
+            d_hi = blend_color_sse2( d_hi, s_hi, alpha, inv_alpha );
+        }
+        else
+        {
+            if (blend.SourceConstantAlpha != 255)
+            {
+                s_lo = div255_round_sse2( _mm_mullo_epi16( s_lo, alpha ));
+                s_hi = div255_round_sse2( _mm_mullo_epi16( s_hi, alpha ));
+            }
+            d_lo = blend_argb_sse2( d_lo, s_lo );
+            d_hi = blend_argb_sse2( d_hi, s_hi );
+            /* a source that isn't properly premultiplied can overflow the channels,
+             * leave it to the scalar code to get the exact same results */
+            if (_mm_movemask_epi8( _mm_or_si128( _mm_cmpgt_epi16( d_lo, max ),
+                                                 _mm_cmpgt_epi16( d_hi, max )))) break;
+        }
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_packus_epi16( d_lo, d_hi ));
+    }
+    return x;
+}
+
+#endif  /* __SSE2__ */
+
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
                             const dib_info *src, const POINT *origin, BLENDFUNCTION blend)
 {
@@ -4189,6 +4288,29 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
     int x, y;
 
+#ifdef __SSE2__
+    BOOL use_src_alpha = (blend.AlphaFormat & AC_SRC_ALPHA) || src->compression == BI_RGB;
+
+    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+    {
+        x = blend_row_8888_sse2( dst_ptr, src_ptr, rc->right - rc->left, blend, use_src_alpha );
+        if (!(blend.AlphaFormat & AC_SRC_ALPHA))
+        {
+            if (use_src_alpha)
+                for (; x < rc->right - rc->left; x++)
+                    dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+            else
+                for (; x < rc->right - rc->left; x++)
+                    dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        }
+        else if (blend.SourceConstantAlpha == 255)
+            for (; x < rc->right - rc->left; x++)
+                dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+        else
+            for (; x < rc->right - rc->left; x++)
+                dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+    }
+#else
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
 	if (blend.SourceConstantAlpha == 255)
@@ -4208,6 +4330,7 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
 	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
 	    for (x = 0; x < rc->right - rc->left; x++)
 		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+#endif
 }
 
 static void blend_rect_32(const dib_info *dst, const RECT *rc,
@@ -511,12 +511,32 @@ typedef struct EMF_dc_state
     struct EMF_dc_state *next;
 } EMF_dc_state;
 
+/* pens and brushes deleted by the metafile are kept around for a while, since
+ * metafiles tend to create the same ones over and over again */
+#define EMF_OBJECT_CACHE_SIZE 16
+
+typedef struct EMF_object_key
+{
+    DWORD   type;   /* EMR_CREATEPEN or EMR_CREATEBRUSHINDIRECT */
+    union
+    {
+        LOGPEN     pen;
+        LOGBRUSH32 brush;
+    } u;
+    HGDIOBJ handle;
+} EMF_object_key;
+
 typedef struct enum_emh_data
 {
     XFORM init_transform;
     EMF_dc_state state;
     INT save_level;
     EMF_dc_state *saved_state;
+    XFORM applied_transform;    /* last transform set on the DC */
+    BOOL transform_valid;       /* the DC still uses applied_transform */
+    EMF_object_key *keys;       /* creation parameters of the handle table entries */
+    INT cache_count;
+    EMF_object_key cache[EMF_OBJECT_CACHE_SIZE];
 } enum_emh_data;
 
 #define ENUM_GET_PRIVATE_DATA(ht) \
@@ -527,7 +547,7 @@ typedef struct enum_emh_data
 
 #define IS_WIN9X() (GetVersion()&0x80000000)
 
-static void EMF_Update_MF_Xform(HDC hdc, const enum_emh_data *info)
+static void EMF_Update_MF_Xform(HDC hdc, enum_emh_data *info)
 {
     XFORM mapping_mode_trans, final_trans;
     double scaleX, scaleY;
@@ -543,11 +563,68 @@ static void EMF_Update_MF_Xform(HDC hdc, const enum_emh_data *info)
 
     CombineTransform(&final_trans, &info->state.world_transform, &mapping_mode_trans);
     CombineTransform(&final_trans, &final_trans, &info->init_transform);
- 
+
+    if (info->transform_valid && !memcmp( &final_trans, &info->applied_transform, sizeof(final_trans) ))
+        return;
+
     if (!SetWorldTransform(hdc, &final_trans))
     {
         ERR("World transform failed!\n");
+        info->transform_valid = FALSE;
+        return;
+    }
+    info->applied_transform = final_trans;
+    info->transform_valid = TRUE;
+}
+
+/* look for a deleted pen or brush with the same parameters */
+static HGDIOBJ EMF_GetCachedObject( enum_emh_data *info, DWORD type, const void *data, UINT size )
+{
+    INT i;
+
+    for (i = info->cache_count - 1; i >= 0; i--)
+    {
+        HGDIOBJ handle = info->cache[i].handle;
+
+        if (info->cache[i].type != type || memcmp( &info->cache[i].u, data, size )) continue;
+        info->cache_count--;
+        memmove( &info->cache[i], &info->cache[i + 1], (info->cache_count - i) * sizeof(info->cache[0]) );
+        return handle;
     }
+    return 0;
+}
+
+static void EMF_SetObjectKey( enum_emh_data *info, UINT index, DWORD type, const void *data, UINT size )
+{
+    HANDLETABLE *ht = (HANDLETABLE *)&info[1];
+
+    if (!info->keys || !ht->objectHandle[index]) return;
+    info->keys[index].type = type;
+    memcpy( &info->keys[index].u, data, size );
+    info->keys[index].handle = ht->objectHandle[index];
+}
+
+/* delete a handle table entry, or move it to the cache if it can be reused */
+static void EMF_DeleteObject( enum_emh_data *info, UINT index )
+{
+    HANDLETABLE *ht = (HANDLETABLE *)&info[1];
+    HGDIOBJ handle = ht->objectHandle[index];
+
+    ht->objectHandle[index] = 0;
+    if (!handle) return;
+    if (!info->keys || !info->keys[index].type || info->keys[index].handle != handle)
+    {
+        DeleteObject( handle );
+        return;
+    }
+    if (info->cache_count == EMF_OBJECT_CACHE_SIZE)
+    {
+        DeleteObject( info->cache[0].handle );
+        info->cache_count--;
+        memmove( &info->cache[0], &info->cache[1], info->cache_count * sizeof(info->cache[0]) );
+    }
+    info->cache[info->cache_count++] = info->keys[index];
+    info->keys[index].type = 0;
 }
 
 static void EMF_RestoreDC( enum_emh_data *info, INT level )
@@ -841,6 +918,7 @@ BOOL WINAPI PlayEnhMetaFileRecord(
         TRACE("EMR_RESTORE: %d\n", pRestoreDC->iRelative);
         if (RestoreDC( hdc, pRestoreDC->iRelative ))
             EMF_RestoreDC( info, pRestoreDC->iRelative );
+        info->transform_valid = FALSE;
 	break;
       }
     case EMR_INTERSECTCLIPRECT:
@@ -874,8 +952,7 @@ BOOL WINAPI PlayEnhMetaFileRecord(
     case EMR_DELETEOBJECT:
       {
 	const EMRDELETEOBJECT *pDeleteObject = (const EMRDELETEOBJECT *)mr;
-	DeleteObject( (handletable->objectHandle)[pDeleteObject->ihObject]);
-	(handletable->objectHandle)[pDeleteObject->ihObject] = 0;
+        EMF_DeleteObject( info, pDeleteObject->ihObject );
 	break;
       }
     case EMR_SETWINDOWORGEX:
@@ -927,8 +1004,11 @@ BOOL WINAPI PlayEnhMetaFileRecord(
     case EMR_CREATEPEN:
       {
 	const EMRCREATEPEN *pCreatePen = (const EMRCREATEPEN *)mr;
-	(handletable->objectHandle)[pCreatePen->ihPen] =
-	  CreatePenIndirect(&pCreatePen->lopn);
+	HPEN pen = EMF_GetCachedObject( info, EMR_CREATEPEN, &pCreatePen->lopn, sizeof(pCreatePen->lopn) );
+
+	if (!pen) pen = CreatePenIndirect(&pCreatePen->lopn);
+	(handletable->objectHandle)[pCreatePen->ihPen] = pen;
+	EMF_SetObjectKey( info, pCreatePen->ihPen, EMR_CREATEPEN, &pCreatePen->lopn, sizeof(pCreatePen->lopn) );
 	break;
       }
     case EMR_EXTCREATEPEN:
@@ -950,11 +1030,18 @@ BOOL WINAPI PlayEnhMetaFileRecord(
     case EMR_CREATEBRUSHINDIRECT:
       {
 	const EMRCREATEBRUSHINDIRECT *pBrush = (const EMRCREATEBRUSHINDIRECT *)mr;
-        LOGBRUSH brush;
-        brush.lbStyle = pBrush->lb.lbStyle;
-        brush.lbColor = pBrush->lb.lbColor;
-        brush.lbHatch = pBrush->lb.lbHatch;
-        (handletable->objectHandle)[pBrush->ihBrush] = CreateBrushIndirect(&brush);
+        HBRUSH hbrush = EMF_GetCachedObject( info, EMR_CREATEBRUSHINDIRECT, &pBrush->lb, sizeof(pBrush->lb) );
+
+        if (!hbrush)
+        {
+            LOGBRUSH brush;
+            brush.lbStyle = pBrush->lb.lbStyle;
+            brush.lbColor = pBrush->lb.lbColor;
+            brush.lbHatch = pBrush->lb.lbHatch;
+            hbrush = CreateBrushIndirect(&brush);
+        }
+        (handletable->objectHandle)[pBrush->ihBrush] = hbrush;
+        EMF_SetObjectKey( info, pBrush->ihBrush, EMR_CREATEBRUSHINDIRECT, &pBrush->lb, sizeof(pBrush->lb) );
 	break;
       }
     case EMR_EXTCREATEFONTINDIRECTW:
@@ -2208,6 +2295,13 @@ BOOL WINAPI PlayEnhMetaFileRecord(
   return TRUE;
 }
 
+static INT CALLBACK EMF_PlayEnhMetaFileCallback(HDC hdc, HANDLETABLE *ht,
+						const ENHMETARECORD *emr,
+						INT handles, LPARAM data)
+{
+    return PlayEnhMetaFileRecord(hdc, ht, emr, handles);
+}
+
 
 /*****************************************************************************
  *
@@ -2268,6 +2362,7 @@ BOOL WINAPI EnumEnhMetaFile(
     POINT vp_org, win_org;
     INT mapMode = MM_TEXT, old_align = 0, old_rop2 = 0, old_arcdir = 0, old_polyfill = 0, old_stretchblt = 0;
     COLORREF old_text_color = 0, old_bk_color = 0;
+    BOOL win9x;
 
     if(!lpRect && hdc)
     {
@@ -2303,6 +2398,9 @@ BOOL WINAPI EnumEnhMetaFile(
     info->state.next = NULL;
     info->save_level = 0;
     info->saved_state = NULL;
+    info->transform_valid = FALSE;
+    info->keys = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, emh->nHandles * sizeof(*info->keys) );
+    info->cache_count = 0;
 
     ht = (HANDLETABLE*) &info[1];
     ht->objectHandle[0] = hmf;
@@ -2407,21 +2505,26 @@ BOOL WINAPI EnumEnhMetaFile(
 
     ret = TRUE;
     offset = 0;
+    win9x = IS_WIN9X();
     while(ret && offset < emh->nBytes)
     {
 	emr = (ENHMETARECORD *)((char *)emh + offset);
 
         /* In Win9x mode we update the xform if the record will produce output */
-        if (hdc && IS_WIN9X() && emr_produces_output(emr->iType))
+        if (hdc && win9x && emr_produces_output(emr->iType))
             EMF_Update_MF_Xform(hdc, info);
 
 	TRACE("Calling EnumFunc with record %s, size %d\n", get_emr_name(emr->iType), emr->nSize);
 	ret = (*callback)(hdc, ht, emr, emh->nHandles, (LPARAM)data);
 	offset += emr->nSize;
 
+        /* an application callback may have changed the DC transform behind our back,
+           our own playback only does it through EMF_Update_MF_Xform and RestoreDC */
+        if (callback != EMF_PlayEnhMetaFileCallback) info->transform_valid = FALSE;
+
         /* WinNT - update the transform (win9x updates when the next graphics
            output record is played). */
-        if (hdc && !IS_WIN9X())
+        if (hdc && !win9x)
             EMF_Update_MF_Xform(hdc, info);
     }
 
@@ -2455,6 +2558,9 @@ BOOL WINAPI EnumEnhMetaFile(
     for(i = 1; i < emh->nHandles; i++) /* Don't delete element 0 (hmf) */
         if( (ht->objectHandle)[i] )
 	    DeleteObject( (ht->objectHandle)[i] );
+    for (i = 0; i < info->cache_count; i++)
+        DeleteObject( info->cache[i].handle );
+    HeapFree( GetProcessHeap(), 0, info->keys );
 
     while (info->saved_state)
     {
@@ -2466,13 +2572,6 @@ BOOL WINAPI EnumEnhMetaFile(
     return ret;
 }
 
-static INT CALLBACK EMF_PlayEnhMetaFileCallback(HDC hdc, HANDLETABLE *ht,
-						const ENHMETARECORD *emr,
-						INT handles, LPARAM data)
-{
-    return PlayEnhMetaFileRecord(hdc, ht, emr, handles);
-}
-
 /**************************************************************************
  *    PlayEnhMetaFile  (GDI32.@)
  *
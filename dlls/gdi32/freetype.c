@@ -240,6 +240,7 @@ struct enum_data
 
 typedef struct tagFace {
     struct list entry;
+    struct list full_name_entry;  /* entry in the full name hash table */
     unsigned int refcount;
     WCHAR *StyleName;
     WCHAR *FullName;
@@ -269,6 +270,8 @@ typedef struct tagFace {
 
 typedef struct tagFamily {
     struct list entry;
+    struct list name_entry;     /* entry in the family name hash table */
+    struct list english_entry;  /* entry in the English name hash table */
     unsigned int refcount;
     WCHAR *FamilyName;
     WCHAR *EnglishName;
@@ -304,6 +307,7 @@ typedef struct {
 
 struct tagGdiFont {
     struct list entry;
+    struct list hash_entry;
     struct list unused_entry;
     unsigned int refcount;
     GM **gm;
@@ -361,9 +365,10 @@ struct enum_charset_list {
 #define FONT_GM(font,idx) (&(font)->gm[(idx) / GM_BLOCK_SIZE][(idx) % GM_BLOCK_SIZE])
 
 static struct list gdi_font_list = LIST_INIT(gdi_font_list);
+static struct list gdi_font_hash[64];
 static struct list unused_gdi_font_list = LIST_INIT(unused_gdi_font_list);
 static unsigned int unused_font_count;
-#define UNUSED_CACHE_SIZE 10
+#define UNUSED_CACHE_SIZE 32
 static struct list system_links = LIST_INIT(system_links);
 
 static struct list font_subst_list = LIST_INIT(font_subst_list);
@@ -465,6 +470,7 @@ typedef struct {
 
 typedef struct tagFontSubst {
     struct list entry;
+    struct list hash_entry;
     NameCs from;
     NameCs to;
 } FontSubst;
@@ -958,11 +964,39 @@ static Face *find_face_from_filename(const WCHAR *file_name, const WCHAR *face_n
     return NULL;
 }
 
+/* case-insensitive hash tables used to look up families, faces and substitutes by name */
+#define NAME_HASH_SIZE 1024
+
+static struct list family_name_hash[NAME_HASH_SIZE];
+static struct list family_english_hash[NAME_HASH_SIZE];
+static struct list face_full_name_hash[NAME_HASH_SIZE];
+static struct list font_subst_hash[NAME_HASH_SIZE];
+
+static struct list *get_name_bucket( struct list *table, const WCHAR *name )
+{
+    unsigned int hash = 0;
+    struct list *bucket;
+
+    while (*name) hash = hash * 31 + tolowerW( *name++ );
+    bucket = &table[hash % NAME_HASH_SIZE];
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
+static void add_family_to_hash( Family *family )
+{
+    list_add_tail( get_name_bucket( family_name_hash, family->FamilyName ), &family->name_entry );
+    if (family->EnglishName)
+        list_add_tail( get_name_bucket( family_english_hash, family->EnglishName ), &family->english_entry );
+    else
+        list_init( &family->english_entry );
+}
+
 static Family *find_family_from_name(const WCHAR *name)
 {
     Family *family;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    LIST_FOR_EACH_ENTRY(family, get_name_bucket( family_name_hash, name ), Family, name_entry)
     {
         if(!strcmpiW(family->FamilyName, name))
             return family;
@@ -971,15 +1005,25 @@ static Family *find_family_from_name(const WCHAR *name)
     return NULL;
 }
 
+/* check whether family comes before other in the font list */
+static BOOL family_is_before(const Family *family, const Family *other)
+{
+    const struct list *ptr;
+
+    for (ptr = list_next( &font_list, &family->entry ); ptr; ptr = list_next( &font_list, ptr ))
+        if (ptr == &other->entry) return TRUE;
+    return FALSE;
+}
+
 static Family *find_family_from_any_name(const WCHAR *name)
 {
     Family *family;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    if ((family = find_family_from_name(name))) return family;
+
+    LIST_FOR_EACH_ENTRY(family, get_name_bucket( family_english_hash, name ), Family, english_entry)
     {
-        if(!strcmpiW(family->FamilyName, name))
-            return family;
-        if(family->EnglishName && !strcmpiW(family->EnglishName, name))
+        if(!strcmpiW(family->EnglishName, name))
             return family;
     }
 
@@ -1016,7 +1060,10 @@ static FontSubst *get_font_subst(const struct list *subst_list, const WCHAR *fro
 {
     FontSubst *element;
 
-    LIST_FOR_EACH_ENTRY(element, subst_list, FontSubst, entry)
+    assert( subst_list == &font_subst_list );
+
+    /* the hash buckets keep the list order, so the first match is the same */
+    LIST_FOR_EACH_ENTRY(element, get_name_bucket( font_subst_hash, from_name ), FontSubst, hash_entry)
     {
         if(!strcmpiW(element->from.name, from_name) &&
            (element->from.charset == from_charset ||
@@ -1038,6 +1085,7 @@ static BOOL add_font_subst(struct list *subst_list, FontSubst *subst, INT flags)
     if(from_exist && (flags & ADD_FONT_SUBST_FORCE))
     {
         list_remove(&from_exist->entry);
+        list_remove(&from_exist->hash_entry);
         HeapFree(GetProcessHeap(), 0, from_exist->from.name);
         HeapFree(GetProcessHeap(), 0, from_exist->to.name);
         HeapFree(GetProcessHeap(), 0, from_exist);
@@ -1055,6 +1103,7 @@ static BOOL add_font_subst(struct list *subst_list, FontSubst *subst, INT flags)
         }
             
         list_add_tail(subst_list, &subst->entry);
+        list_add_tail(get_name_bucket( font_subst_hash, subst->from.name ), &subst->hash_entry);
 
         return TRUE;
     }
@@ -1394,6 +1443,8 @@ static void release_family( Family *family )
     if (--family->refcount) return;
     assert( list_empty( &family->faces ));
     list_remove( &family->entry );
+    list_remove( &family->name_entry );
+    list_remove( &family->english_entry );
     HeapFree( GetProcessHeap(), 0, family->FamilyName );
     HeapFree( GetProcessHeap(), 0, family->EnglishName );
     HeapFree( GetProcessHeap(), 0, family );
@@ -1406,6 +1457,7 @@ static void release_face( Face *face )
     {
         if (face->flags & ADDFONT_ADD_TO_CACHE) remove_face_from_cache( face );
         list_remove( &face->entry );
+        list_remove( &face->full_name_entry );
         release_family( face->family );
     }
     HeapFree( GetProcessHeap(), 0, face->file );
@@ -1436,6 +1488,14 @@ static inline int style_order(const Face *face)
     }
 }
 
+static void add_face_to_hash( Face *face )
+{
+    if (face->FullName)
+        list_add_tail( get_name_bucket( face_full_name_hash, face->FullName ), &face->full_name_entry );
+    else
+        list_init( &face->full_name_entry );
+}
+
 static BOOL insert_face_in_family_list( Face *face, Family *family )
 {
     Face *cursor;
@@ -1466,6 +1526,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
                 TRACE("Replacing original %s with %s\n",
                       debugstr_w(cursor->file), debugstr_w(face->file));
                 list_add_before( &cursor->entry, &face->entry );
+                add_face_to_hash( face );
                 face->family = family;
                 family->refcount++;
                 face->refcount++;
@@ -1480,6 +1541,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
     }
 
     list_add_before( &cursor->entry, &face->entry );
+    add_face_to_hash( face );
     face->family = family;
     family->refcount++;
     face->refcount++;
@@ -1499,6 +1561,7 @@ static Family *create_family( WCHAR *name, WCHAR *english_name )
     list_init( &family->faces );
     family->replacement = &family->faces;
     list_add_tail( &font_list, &family->entry );
+    add_family_to_hash( family );
 
     return family;
 }
@@ -1684,6 +1747,490 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
     reorder_vertical_fonts();
 }
 
+/* Binary font list file
+ *
+ * The font list built by the first process of a session is also saved in a file in the
+ * configuration directory.  This file is used instead of the registry font cache by the
+ * other processes of the session as long as no font was added or removed in the meantime,
+ * and to avoid rescanning all the fonts when the font directories haven't changed.
+ */
+
+#define FONT_LIST_FILE_MAGIC   0x4c464e57  /* "WNFL" */
+#define FONT_LIST_FILE_VERSION 1
+
+struct font_list_file_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD size;        /* total size of the file */
+    DWORD stamp;       /* matched against the stamp stored in the registry font cache */
+    DWORD data_dir;    /* offset of the Wine data directory */
+    DWORD font_path;   /* offset of the HKCU\Software\Wine\Fonts Path value */
+    DWORD dir_count;
+    DWORD dirs;        /* offset of the font_list_file_dir array */
+    DWORD face_count;
+    DWORD faces;       /* offset of the font_list_file_face array */
+};
+
+struct font_list_file_dir
+{
+    DWORD     name;    /* offset of the Unix directory name */
+    DWORD     pad;
+    ULONGLONG mtime;
+};
+
+struct font_list_file_face
+{
+    DWORD         family;        /* string offsets, 0 if not present */
+    DWORD         english_name;
+    DWORD         style;
+    DWORD         full_name;
+    DWORD         file;
+    DWORD         face_index;
+    DWORD         ntm_flags;
+    DWORD         font_version;
+    DWORD         flags;
+    FONTSIGNATURE fs;
+    DWORD         scalable;
+    INT           height;
+    INT           width;
+    INT           size;
+    INT           x_ppem;
+    INT           y_ppem;
+    INT           internal_leading;
+};
+
+struct font_list_dir
+{
+    struct list  entry;
+    char        *name;
+};
+
+static const WCHAR font_list_stamp_value[] = {'F','i','l','e',' ','S','t','a','m','p',0};
+static struct list font_list_dirs = LIST_INIT( font_list_dirs );
+static BOOL font_list_file_valid;
+
+static void add_font_list_dir( const char *name, int len )
+{
+    struct font_list_dir *dir;
+
+    LIST_FOR_EACH_ENTRY( dir, &font_list_dirs, struct font_list_dir, entry )
+        if (!strncmp( dir->name, name, len ) && !dir->name[len]) return;
+
+    if (!(dir = HeapAlloc( GetProcessHeap(), 0, sizeof(*dir) ))) return;
+    if (!(dir->name = HeapAlloc( GetProcessHeap(), 0, len + 1 )))
+    {
+        HeapFree( GetProcessHeap(), 0, dir );
+        return;
+    }
+    memcpy( dir->name, name, len );
+    dir->name[len] = 0;
+    list_add_tail( &font_list_dirs, &dir->entry );
+}
+
+static char *get_font_list_file_name(void)
+{
+    const char *config_dir = wine_get_config_dir();
+    char *name;
+
+    if (!config_dir) return NULL;
+    if ((name = HeapAlloc( GetProcessHeap(), 0, strlen(config_dir) + sizeof("/fontlist.cache") )))
+    {
+        strcpy( name, config_dir );
+        strcat( name, "/fontlist.cache" );
+    }
+    return name;
+}
+
+static const char *get_font_data_dir(void)
+{
+    const char *data_dir = wine_get_data_dir();
+    if (!data_dir) data_dir = wine_get_build_dir();
+    return data_dir ? data_dir : "";
+}
+
+static WCHAR *get_font_path_value(void)
+{
+    static const WCHAR pathW[] = {'P','a','t','h',0};
+    WCHAR *value = NULL;
+    DWORD len;
+    HKEY hkey;
+
+    if (RegOpenKeyW( HKEY_CURRENT_USER, wine_fonts_key, &hkey )) return NULL;
+    if (!RegQueryValueExW( hkey, pathW, NULL, NULL, NULL, &len ) &&
+        (value = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, len + sizeof(WCHAR) )))
+        RegQueryValueExW( hkey, pathW, NULL, NULL, (BYTE *)value, &len );
+    RegCloseKey( hkey );
+    return value;
+}
+
+static DWORD get_font_list_stamp(void)
+{
+    DWORD stamp;
+    return reg_load_dword( hkey_font_cache, font_list_stamp_value, &stamp ) ? 0 : stamp;
+}
+
+static void set_font_list_stamp( DWORD stamp )
+{
+    if (!stamp) return;
+    reg_save_dword( hkey_font_cache, font_list_stamp_value, stamp );
+    font_list_file_valid = TRUE;
+}
+
+/* called when the registry font cache is modified, other processes must not use the file anymore */
+static void invalidate_font_list_file(void)
+{
+    if (!font_list_file_valid) return;
+    TRACE( "font list changed, invalidating font list file\n" );
+    RegDeleteValueW( hkey_font_cache, font_list_stamp_value );
+    font_list_file_valid = FALSE;
+}
+
+static const void *get_font_list_str( const struct font_list_file_header *header, DWORD offset, DWORD char_size )
+{
+    const BYTE *ptr = (const BYTE *)header + offset, *end = (const BYTE *)header + header->size;
+
+    if (!offset) return NULL;
+    if (offset >= header->size || offset % char_size) return NULL;
+    for ( ; ptr + char_size <= end; ptr += char_size)
+        if (char_size == 1 ? !*ptr : !*(const WCHAR *)ptr) return (const BYTE *)header + offset;
+    return NULL;
+}
+
+static BOOL font_list_str_equal( const struct font_list_file_header *header, DWORD offset, const WCHAR *str )
+{
+    const WCHAR *file_str = get_font_list_str( header, offset, sizeof(WCHAR) );
+
+    if (!str || !*str) return !file_str || !*file_str;
+    return file_str && !strcmpW( file_str, str );
+}
+
+static BOOL validate_font_list_file( const struct font_list_file_header *header, SIZE_T size, DWORD stamp )
+{
+    const struct font_list_file_dir *dirs;
+    const struct font_list_file_face *faces;
+    const char *str;
+    struct stat st;
+    WCHAR *font_path;
+    BOOL ret;
+    DWORD i;
+
+    if (size < sizeof(*header) || header->magic != FONT_LIST_FILE_MAGIC ||
+        header->version != FONT_LIST_FILE_VERSION || header->size != size)
+        return FALSE;
+    if (header->dirs % sizeof(ULONGLONG) || header->dirs > size ||
+        header->dir_count > (size - header->dirs) / sizeof(*dirs))
+        return FALSE;
+    if (header->faces % sizeof(DWORD) || header->faces > size ||
+        header->face_count > (size - header->faces) / sizeof(*faces))
+        return FALSE;
+
+    dirs = (const struct font_list_file_dir *)((const BYTE *)header + header->dirs);
+    faces = (const struct font_list_file_face *)((const BYTE *)header + header->faces);
+    for (i = 0; i < header->face_count; i++)
+        if (!get_font_list_str( header, faces[i].family, sizeof(WCHAR) ) ||
+            !get_font_list_str( header, faces[i].style, sizeof(WCHAR) ) ||
+            !get_font_list_str( header, faces[i].file, sizeof(WCHAR) ))
+            return FALSE;
+
+    /* the other processes of a session only need to check that the font list hasn't changed */
+    if (stamp) return header->stamp == stamp;
+
+    if (!(str = get_font_list_str( header, header->data_dir, 1 )) || strcmp( str, get_font_data_dir() ))
+        return FALSE;
+
+    font_path = get_font_path_value();
+    ret = font_list_str_equal( header, header->font_path, font_path );
+    HeapFree( GetProcessHeap(), 0, font_path );
+    if (!ret) return FALSE;
+
+    for (i = 0; i < header->dir_count; i++)
+    {
+        if (!(str = get_font_list_str( header, dirs[i].name, 1 ))) return FALSE;
+        if (stat( str, &st ) == -1 || st.st_mtime != dirs[i].mtime)
+        {
+            TRACE( "%s has changed\n", debugstr_a(str) );
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* load the font list from the file, returns FALSE if it's missing or out of date */
+static BOOL load_font_list_from_file( DWORD *stamp )
+{
+    const struct font_list_file_header *header;
+    const struct font_list_file_face *faces;
+    Family *family = NULL;
+    struct stat st;
+    char *name;
+    void *data;
+    int fd;
+    DWORD i;
+
+    if (!(name = get_font_list_file_name())) return FALSE;
+    fd = open( name, O_RDONLY );
+    HeapFree( GetProcessHeap(), 0, name );
+    if (fd == -1) return FALSE;
+    if (fstat( fd, &st ) == -1 || !st.st_size || st.st_size > 0x7fffffff)
+    {
+        close( fd );
+        return FALSE;
+    }
+    data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if (data == MAP_FAILED) return FALSE;
+
+    header = data;
+    if (!validate_font_list_file( header, st.st_size, *stamp ))
+    {
+        TRACE( "font list file is out of date\n" );
+        munmap( data, st.st_size );
+        return FALSE;
+    }
+
+    faces = (const struct font_list_file_face *)((const BYTE *)header + header->faces);
+    for (i = 0; i < header->face_count; i++)
+    {
+        const WCHAR *family_name = get_font_list_str( header, faces[i].family, sizeof(WCHAR) );
+        const WCHAR *english_name = get_font_list_str( header, faces[i].english_name, sizeof(WCHAR) );
+        const WCHAR *full_name = get_font_list_str( header, faces[i].full_name, sizeof(WCHAR) );
+        Face *face;
+
+        if (!family || strcmpW( family->FamilyName, family_name ))
+        {
+            if (family) release_family( family );
+            family = create_family( strdupW( family_name ), english_name ? strdupW( english_name ) : NULL );
+            if (english_name)
+            {
+                FontSubst *subst = HeapAlloc( GetProcessHeap(), 0, sizeof(*subst) );
+                subst->from.name = strdupW( english_name );
+                subst->from.charset = -1;
+                subst->to.name = strdupW( family_name );
+                subst->to.charset = -1;
+                add_font_subst( &font_subst_list, subst, 0 );
+            }
+        }
+
+        face = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*face) );
+        face->refcount     = 1;
+        face->StyleName    = strdupW( get_font_list_str( header, faces[i].style, sizeof(WCHAR) ));
+        face->FullName     = full_name ? strdupW( full_name ) : NULL;
+        face->file         = strdupW( get_font_list_str( header, faces[i].file, sizeof(WCHAR) ));
+        face->face_index   = faces[i].face_index;
+        face->ntmFlags     = faces[i].ntm_flags;
+        face->font_version = faces[i].font_version;
+        face->flags        = faces[i].flags;
+        face->fs           = faces[i].fs;
+        face->scalable     = faces[i].scalable;
+        if (!face->scalable)
+        {
+            face->size.height           = faces[i].height;
+            face->size.width            = faces[i].width;
+            face->size.size             = faces[i].size;
+            face->size.x_ppem           = faces[i].x_ppem;
+            face->size.y_ppem           = faces[i].y_ppem;
+            face->size.internal_leading = faces[i].internal_leading;
+        }
+
+        if (insert_face_in_family_list( face, family ))
+            TRACE("Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName));
+        release_face( face );
+    }
+    if (family) release_family( family );
+
+    TRACE( "loaded %u faces from font list file\n", header->face_count );
+    *stamp = header->stamp;
+    munmap( data, st.st_size );
+
+    reorder_vertical_fonts();
+    return TRUE;
+}
+
+struct font_list_buffer
+{
+    BYTE  *data;
+    DWORD  size;
+    DWORD  alloc;
+};
+
+/* append some data to the buffer, aligned on a DWORD boundary, returns its offset or 0 on failure */
+static DWORD add_font_list_data( struct font_list_buffer *buffer, const void *data, DWORD size )
+{
+    DWORD offset = buffer->size, aligned = (size + 3) & ~3;
+
+    if (!buffer->data) return 0;
+    if (offset + aligned > buffer->alloc)
+    {
+        BYTE *new_data;
+        DWORD new_alloc = max( buffer->alloc * 2, offset + aligned );
+
+        if (!(new_data = HeapReAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, buffer->data, new_alloc )))
+        {
+            HeapFree( GetProcessHeap(), 0, buffer->data );
+            buffer->data = NULL;
+            return 0;
+        }
+        buffer->data = new_data;
+        buffer->alloc = new_alloc;
+    }
+    if (data) memcpy( buffer->data + offset, data, size );
+    buffer->size += aligned;
+    return offset;
+}
+
+static DWORD add_font_list_strW( struct font_list_buffer *buffer, const WCHAR *str )
+{
+    if (!str) return 0;
+    return add_font_list_data( buffer, str, (strlenW( str ) + 1) * sizeof(WCHAR) );
+}
+
+static DWORD add_font_list_strA( struct font_list_buffer *buffer, const char *str )
+{
+    return add_font_list_data( buffer, str, strlen( str ) + 1 );
+}
+
+static int face_cache_cmp( const void *p1, const void *p2 )
+{
+    const Face *face1 = *(const Face * const *)p1, *face2 = *(const Face * const *)p2;
+    int ret;
+
+    /* same order as enumerating the registry font cache */
+    if ((ret = strcmpiW( face1->family->FamilyName, face2->family->FamilyName ))) return ret;
+    if ((ret = strcmpiW( face1->StyleName, face2->StyleName ))) return ret;
+    if (face1->scalable != face2->scalable) return face2->scalable - face1->scalable;
+    return face1->size.y_ppem - face2->size.y_ppem;
+}
+
+/* save the current font list, returns the file stamp or 0 on failure */
+static DWORD save_font_list_to_file(void)
+{
+    struct font_list_buffer buffer;
+    struct font_list_file_header *header;
+    struct font_list_file_dir *dir_data;
+    struct font_list_file_face *face_data;
+    struct font_list_dir *dir;
+    Family *family;
+    Face *face, **faces = NULL;
+    WCHAR *font_path;
+    char *name = NULL, *tmp_name = NULL, *unix_name;
+    DWORD i, count = 0, dir_count = 0, stamp = 0, offset;
+    struct stat st;
+    int fd, len;
+    BOOL ret;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+            if ((face->flags & ADDFONT_ADD_TO_CACHE) && face->file) count++;
+
+    if (!(faces = HeapAlloc( GetProcessHeap(), 0, max( count, 1 ) * sizeof(*faces) ))) return 0;
+    count = 0;
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+    {
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE) || !face->file) continue;
+            faces[count++] = face;
+
+            /* also check the directories of fonts that were loaded individually */
+            len = WideCharToMultiByte( CP_UNIXCP, 0, face->file, -1, NULL, 0, NULL, NULL );
+            if (!(unix_name = HeapAlloc( GetProcessHeap(), 0, len ))) continue;
+            WideCharToMultiByte( CP_UNIXCP, 0, face->file, -1, unix_name, len, NULL, NULL );
+            if (strrchr( unix_name, '/' )) add_font_list_dir( unix_name, strrchr( unix_name, '/' ) - unix_name );
+            HeapFree( GetProcessHeap(), 0, unix_name );
+        }
+    }
+    qsort( faces, count, sizeof(*faces), face_cache_cmp );
+    dir_count = list_count( &font_list_dirs );
+
+    buffer.size = 0;
+    buffer.alloc = sizeof(*header) + dir_count * sizeof(*dir_data) + count * sizeof(*face_data) + 0x10000;
+    buffer.data = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, buffer.alloc );
+    add_font_list_data( &buffer, NULL, sizeof(*header) );
+    add_font_list_data( &buffer, NULL, dir_count * sizeof(*dir_data) );
+    add_font_list_data( &buffer, NULL, count * sizeof(*face_data) );
+
+    i = 0;
+    LIST_FOR_EACH_ENTRY( dir, &font_list_dirs, struct font_list_dir, entry )
+    {
+        offset = add_font_list_strA( &buffer, dir->name );
+        if (!buffer.data) goto done;
+        dir_data = (struct font_list_file_dir *)(buffer.data + sizeof(*header)) + i++;
+        dir_data->name = offset;
+        dir_data->mtime = stat( dir->name, &st ) == -1 ? 0 : st.st_mtime;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        struct font_list_file_face data;
+
+        memset( &data, 0, sizeof(data) );
+        data.family           = add_font_list_strW( &buffer, faces[i]->family->FamilyName );
+        data.english_name     = add_font_list_strW( &buffer, faces[i]->family->EnglishName );
+        data.style            = add_font_list_strW( &buffer, faces[i]->StyleName );
+        data.full_name        = add_font_list_strW( &buffer, faces[i]->FullName );
+        data.file             = add_font_list_strW( &buffer, faces[i]->file );
+        data.face_index       = faces[i]->face_index;
+        data.ntm_flags        = faces[i]->ntmFlags;
+        data.font_version     = faces[i]->font_version;
+        data.flags            = faces[i]->flags;
+        data.fs               = faces[i]->fs;
+        data.scalable         = faces[i]->scalable;
+        data.height           = faces[i]->size.height;
+        data.width            = faces[i]->size.width;
+        data.size             = faces[i]->size.size;
+        data.x_ppem           = faces[i]->size.x_ppem;
+        data.y_ppem           = faces[i]->size.y_ppem;
+        data.internal_leading = faces[i]->size.internal_leading;
+        if (!buffer.data) goto done;
+        face_data = (struct font_list_file_face *)(buffer.data + sizeof(*header) + dir_count * sizeof(*dir_data));
+        face_data[i] = data;
+    }
+
+    font_path = get_font_path_value();
+    offset = add_font_list_strW( &buffer, font_path );
+    HeapFree( GetProcessHeap(), 0, font_path );
+    i = add_font_list_strA( &buffer, get_font_data_dir() );
+    if (!buffer.data) goto done;
+
+    header = (struct font_list_file_header *)buffer.data;
+    header->magic      = FONT_LIST_FILE_MAGIC;
+    header->version    = FONT_LIST_FILE_VERSION;
+    header->size       = buffer.size;
+    header->stamp      = ((GetTickCount() << 16) ^ GetCurrentProcessId()) | 1;
+    header->data_dir   = i;
+    header->font_path  = offset;
+    header->dir_count  = dir_count;
+    header->dirs       = sizeof(*header);
+    header->face_count = count;
+    header->faces      = sizeof(*header) + dir_count * sizeof(*dir_data);
+
+    /* write to a temporary file first, so that other processes never see a partial file */
+    if (!(name = get_font_list_file_name())) goto done;
+    if (!(tmp_name = HeapAlloc( GetProcessHeap(), 0, strlen(name) + 16 ))) goto done;
+    sprintf( tmp_name, "%s.%08x", name, GetCurrentProcessId() );
+    if ((fd = open( tmp_name, O_CREAT | O_TRUNC | O_WRONLY, 0644 )) == -1) goto done;
+    ret = write( fd, buffer.data, buffer.size ) == buffer.size;
+    if (close( fd )) ret = FALSE;
+    if (ret && !rename( tmp_name, name ))
+    {
+        TRACE( "saved %u faces to %s\n", count, debugstr_a(name) );
+        stamp = header->stamp;
+    }
+    else
+    {
+        WARN( "failed to write %s\n", debugstr_a(name) );
+        unlink( tmp_name );
+    }
+
+done:
+    HeapFree( GetProcessHeap(), 0, tmp_name );
+    HeapFree( GetProcessHeap(), 0, name );
+    HeapFree( GetProcessHeap(), 0, buffer.data );
+    HeapFree( GetProcessHeap(), 0, faces );
+    return stamp;
+}
+
 static LONG create_font_cache_key(HKEY *hkey, DWORD *disposition)
 {
     LONG ret;
@@ -1709,6 +2256,7 @@ static void add_face_to_cache(Face *face)
     HKEY hkey_family, hkey_face;
     WCHAR *face_key_name;
 
+    invalidate_font_list_file();
     RegCreateKeyExW(hkey_font_cache, face->family->FamilyName, 0,
                     NULL, REG_OPTION_VOLATILE, KEY_ALL_ACCESS, NULL, &hkey_family, NULL);
     if(face->family->EnglishName)
@@ -1758,6 +2306,7 @@ static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
+    invalidate_font_list_file();
     RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family );
 
     if (face->scalable)
@@ -1775,6 +2324,17 @@ static void remove_face_from_cache( Face *face )
     RegCloseKey(hkey_family);
 }
 
+/* populate the registry font cache from a font list loaded from the file */
+static void add_font_list_to_cache(void)
+{
+    Family *family;
+    Face *face;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+            if (face->flags & ADDFONT_ADD_TO_CACHE) add_face_to_cache( face );
+}
+
 static WCHAR *prepend_at(WCHAR *family)
 {
     WCHAR *str;
@@ -2271,6 +2831,7 @@ static void LoadReplaceList(void)
                         list_init(&new_family->faces);
                         new_family->replacement = &family->faces;
                         list_add_tail(&font_list, &new_family->entry);
+                        add_family_to_hash(new_family);
                     }
                 }
                 else
@@ -2597,6 +3158,7 @@ static BOOL ReadFontDir(const char *dirname, BOOL external_fonts)
         WARN("Can't open directory %s\n", debugstr_a(dirname));
 	return FALSE;
     }
+    add_font_list_dir(dirname, strlen(dirname));
     while((dent = readdir(dir)) != NULL) {
 	struct stat statbuf;
 
@@ -4113,7 +4675,7 @@ static void reorder_font_list(void)
  */
 BOOL WineEngInit(void)
 {
-    DWORD disposition;
+    DWORD disposition, stamp = 0;
     HANDLE font_mutex;
 
     /* update locale dependent font info in registry */
@@ -4135,7 +4697,22 @@ BOOL WineEngInit(void)
     create_font_cache_key(&hkey_font_cache, &disposition);
 
     if(disposition == REG_CREATED_NEW_KEY)
-        init_font_list();
+    {
+        /* first process of the session, rescan the fonts only if they have changed */
+        if (load_font_list_from_file(&stamp))
+        {
+            delete_external_font_keys();
+            add_font_list_to_cache();
+        }
+        else
+        {
+            init_font_list();
+            stamp = save_font_list_to_file();
+        }
+        set_font_list_stamp(stamp);
+    }
+    else if ((stamp = get_font_list_stamp()) && load_font_list_from_file(&stamp))
+        font_list_file_valid = TRUE;
     else
         load_font_list_from_cache(hkey_font_cache);
 
@@ -4620,6 +5197,7 @@ static void release_font( GdiFont *font )
             font = LIST_ENTRY( list_tail( &unused_gdi_font_list ), struct tagGdiFont, unused_entry );
             TRACE( "freeing %p\n", font );
             list_remove( &font->entry );
+            list_remove( &font->hash_entry );
             list_remove( &font->unused_entry );
             free_font( font );
         }
@@ -4663,6 +5241,13 @@ static void calc_hash(FONT_DESC *pfd)
     return;
 }
 
+static struct list *get_gdi_font_bucket( DWORD hash )
+{
+    struct list *bucket = &gdi_font_hash[(hash ^ (hash >> 16)) % (sizeof(gdi_font_hash) / sizeof(gdi_font_hash[0]))];
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
 static GdiFont *find_in_cache(HFONT hfont, const LOGFONTW *plf, const FMAT2 *pmat, BOOL can_use_bitmap)
 {
     GdiFont *ret;
@@ -4674,7 +5259,7 @@ static GdiFont *find_in_cache(HFONT hfont, const LOGFONTW *plf, const FMAT2 *pma
     calc_hash(&fd);
 
     /* try the in-use list */
-    LIST_FOR_EACH_ENTRY( ret, &gdi_font_list, struct tagGdiFont, entry )
+    LIST_FOR_EACH_ENTRY( ret, get_gdi_font_bucket( fd.hash ), struct tagGdiFont, hash_entry )
     {
         if(fontcmp(ret, &fd)) continue;
         if(!can_use_bitmap && !FT_IS_SCALABLE(ret->ft_face)) continue;
@@ -4692,6 +5277,7 @@ static void add_to_cache(GdiFont *font)
 
     font->cache_num = cache_num++;
     list_add_head(&gdi_font_list, &font->entry);
+    list_add_head(get_gdi_font_bucket( font->font_desc.hash ), &font->hash_entry);
     TRACE( "font %p\n", font );
 }
 
@@ -5034,10 +5620,10 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
     struct freetype_physdev *physdev = get_freetype_dev( dev );
     GdiFont *ret;
     Face *face, *best, *best_bitmap;
-    Family *family, *last_resort_family;
+    Family *family, *last_resort_family, *families[2];
     const struct list *face_list;
     INT height, width = 0;
-    unsigned int score = 0, new_score;
+    unsigned int i, count, score = 0, new_score;
     signed int diff = 0, newdiff;
     BOOL bd, it, can_use_bitmap, want_vertical;
     LOGFONTW lf;
@@ -5152,40 +5738,48 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
 	   where we'll either use the charset of the current ansi codepage
 	   or if that's unavailable the first charset that the font supports.
 	*/
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            if (!strcmpiW(family->FamilyName, FaceName) ||
-                (psub && !strcmpiW(family->FamilyName, psub->to.name)))
+        count = 0;
+        if ((family = find_family_from_name(FaceName))) families[count++] = family;
+        if (psub && (family = find_family_from_name(psub->to.name)) && (!count || family != families[0]))
+        {
+            /* the first of the two families in the font list wins */
+            if (count && family_is_before(family, families[0]))
             {
-                font_link = find_font_link(family->FamilyName);
-                face_list = get_face_list_from_family(family);
-                LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                    if (!(face->scalable || can_use_bitmap))
-                        continue;
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                        goto found;
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found;
-                    if (!csi.fs.fsCsb[0])
-                        goto found;
-                }
+                families[1] = families[0];
+                families[0] = family;
+            }
+            else families[count] = family;
+            count++;
+        }
+        for (i = 0; i < count; i++)
+        {
+            family = families[i];
+            font_link = find_font_link(family->FamilyName);
+            face_list = get_face_list_from_family(family);
+            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
+                if (!(face->scalable || can_use_bitmap))
+                    continue;
+                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
+                    goto found;
+                if (font_link != NULL &&
+                    csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                    goto found;
+                if (!csi.fs.fsCsb[0])
+                    goto found;
             }
 	}
 
         /* Search by full face name. */
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if(face->FullName && !strcmpiW(face->FullName, FaceName) &&
-                   (face->scalable || can_use_bitmap))
-                {
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
-                        goto found_face;
-                    font_link = find_font_link(family->FamilyName);
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found_face;
-                }
+        LIST_FOR_EACH_ENTRY( face, get_name_bucket( face_full_name_hash, FaceName ), Face, full_name_entry ) {
+            if(!strcmpiW(face->FullName, FaceName) && (face->scalable || can_use_bitmap))
+            {
+                family = face->family;
+                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
+                    goto found_face;
+                font_link = find_font_link(family->FamilyName);
+                if (font_link != NULL &&
+                    csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                    goto found_face;
             }
         }
 
@@ -5245,18 +5839,16 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
         strcpyW(lf.lfFaceName, defSans);
     else
         strcpyW(lf.lfFaceName, defSans);
-    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-        if(!strcmpiW(family->FamilyName, lf.lfFaceName)) {
-            font_link = find_font_link(family->FamilyName);
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if (!(face->scalable || can_use_bitmap))
-                    continue;
-                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                    goto found;
-                if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                    goto found;
-            }
+    if ((family = find_family_from_name(lf.lfFaceName))) {
+        font_link = find_font_link(family->FamilyName);
+        face_list = get_face_list_from_family(family);
+        LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
+            if (!(face->scalable || can_use_bitmap))
+                continue;
+            if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
+                goto found;
+            if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                goto found;
         }
     }
 
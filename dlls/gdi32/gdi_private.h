@@ -262,6 +262,7 @@ extern DWORD put_image_into_bitmap( BITMAPOBJ *bmp, HRGN clip, BITMAPINFO *info,
                                     const struct gdi_image_bits *bits, struct bitblt_coords *src,
                                     struct bitblt_coords *dst ) DECLSPEC_HIDDEN;
 extern void dibdrv_set_window_surface( DC *dc, struct window_surface *surface ) DECLSPEC_HIDDEN;
+extern void dibdrv_flush_batches(void) DECLSPEC_HIDDEN;
 
 /* driver.c */
 extern const struct gdi_dc_funcs null_driver DECLSPEC_HIDDEN;
@@ -336,6 +337,21 @@ typedef struct
     RECT extents;
 } WINEREGION;
 
+/* return the index of the first rectangle of the band containing y, or of the next band below it;
+ * the bands are sorted top to bottom, so this is a binary search on the bottom coordinates */
+static inline INT find_region_band( const WINEREGION *rgn, INT y )
+{
+    INT lo = 0, hi = rgn->numRects, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (rgn->rects[mid].bottom <= y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
 /* return the region data without making a copy */
 static inline const WINEREGION *get_wine_region(HRGN rgn)
 {
@@ -1296,7 +1296,8 @@ DWORD WINAPI GdiInitializeLanguagePack( DWORD arg )
  */
 BOOL WINAPI GdiFlush(void)
 {
-    return TRUE;  /* FIXME */
+    dibdrv_flush_batches();
+    return TRUE;
 }
 
 
@@ -1305,7 +1306,9 @@ BOOL WINAPI GdiFlush(void)
  */
 DWORD WINAPI GdiGetBatchLimit(void)
 {
-    return 1;  /* FIXME */
+    /* batching is off unless the thread asks for it, since a lot of apps
+     * access DIB section bits without calling GdiFlush first */
+    return max( NtCurrentTeb()->GdiBatchCount, 1 );
 }
 
 
@@ -1314,7 +1317,12 @@ DWORD WINAPI GdiGetBatchLimit(void)
  */
 DWORD WINAPI GdiSetBatchLimit( DWORD limit )
 {
-    return 1; /* FIXME */
+    DWORD old_limit = GdiGetBatchLimit();
+
+    if (!limit) limit = 1;
+    GdiFlush();
+    NtCurrentTeb()->GdiBatchCount = limit;
+    return old_limit;
 }
 
 
@@ -1042,15 +1042,23 @@ BOOL WINAPI PtInRegion( HRGN hrgn, INT x, INT y )
 
     if ((obj = GDI_GetObjPtr( hrgn, OBJ_REGION )))
     {
-	int i;
+        if (obj->numRects > 0 && is_in_rect(&obj->extents, x, y))
+        {
+            INT start = find_region_band( obj, y ), end, mid;
 
-	if (obj->numRects > 0 && is_in_rect(&obj->extents, x, y))
-	    for (i = 0; i < obj->numRects; i++)
-		if (is_in_rect(&obj->rects[i], x, y))
+            if (start < obj->numRects && obj->rects[start].top <= y)
+            {
+                /* the rectangles of a band are sorted left to right and don't overlap */
+                end = find_region_band( obj, obj->rects[start].bottom );
+                while (start < end)
                 {
-		    ret = TRUE;
-                    break;
+                    mid = (start + end) / 2;
+                    if (obj->rects[mid].right <= x) start = mid + 1;
+                    else end = mid;
                 }
+                ret = start < obj->numRects && is_in_rect( &obj->rects[start], x, y );
+            }
+        }
 	GDI_ReleaseObj( hrgn );
     }
     return ret;
@@ -1088,7 +1096,7 @@ BOOL WINAPI RectInRegion( HRGN hrgn, const RECT *rect )
     /* this is (just) a useful optimization */
 	if ((obj->numRects > 0) && overlapping(&obj->extents, &rc))
 	{
-	    for (pCurRect = obj->rects, pRectEnd = pCurRect +
+	    for (pCurRect = obj->rects + find_region_band( obj, rc.top ), pRectEnd = obj->rects +
 	     obj->numRects; pCurRect < pRectEnd; pCurRect++)
 	    {
 	        if (pCurRect->bottom <= rc.top)
@@ -1940,7 +1948,26 @@ static BOOL REGION_IntersectRegion(WINEREGION *newReg, WINEREGION *reg1,
 	(!overlapping(&reg1->extents, &reg2->extents)))
 	newReg->numRects = 0;
     else
-	if (!REGION_RegionOp (newReg, reg1, reg2, REGION_IntersectO, NULL, NULL)) return FALSE;
+    {
+        WINEREGION view1 = *reg1, view2 = *reg2;
+        INT start;
+
+        /*
+         * The bands above the top of the other region can't contribute anything,
+         * so skip them directly. The source rectangles are only read by
+         * REGION_RegionOp, the result is built in a separate array.
+         */
+        start = find_region_band( reg1, reg2->extents.top );
+        view1.rects += start;
+        view1.numRects -= start;
+        start = find_region_band( reg2, reg1->extents.top );
+        view2.rects += start;
+        view2.numRects -= start;
+        view1.extents.top = view1.rects[0].top;
+        view2.extents.top = view2.rects[0].top;
+
+	if (!REGION_RegionOp (newReg, &view1, &view2, REGION_IntersectO, NULL, NULL)) return FALSE;
+    }
 
     /*
      * Can't alter newReg's extents before we call miRegionOp because
@@ -2041,6 +2068,56 @@ static BOOL REGION_UnionO (WINEREGION *pReg, RECT *r1, RECT *r1End,
 #undef MERGERECT
 }
 
+/***********************************************************************
+ *	     REGION_AppendRegion
+ *
+ *      Union of two regions where reg2 lies entirely below reg1. The bands
+ *      don't overlap, so the result is reg1 followed by reg2, with the bands
+ *      at the junction coalesced if they line up. This is the common case
+ *      when a region is built one rectangle at a time in y-x order.
+ */
+static BOOL REGION_AppendRegion(WINEREGION *newReg, WINEREGION *reg1, WINEREGION *reg2)
+{
+    INT prevBand, curBand = reg1->numRects, count = reg1->numRects + reg2->numRects;
+    RECT extents;
+
+    extents.left   = min(reg1->extents.left, reg2->extents.left);
+    extents.top    = reg1->extents.top;
+    extents.right  = max(reg1->extents.right, reg2->extents.right);
+    extents.bottom = reg2->extents.bottom;
+
+    prevBand = curBand - 1;
+    while (prevBand > 0 && reg1->rects[prevBand - 1].top == reg1->rects[prevBand].top) prevBand--;
+
+    if (newReg == reg1)
+    {
+        if (count > reg1->size)
+        {
+            INT size = max( count, reg1->size * 2 );
+            RECT *rects = HeapReAlloc( GetProcessHeap(), 0, reg1->rects, size * sizeof(RECT) );
+            if (!rects) return FALSE;
+            reg1->rects = rects;
+            reg1->size = size;
+        }
+        memcpy( reg1->rects + curBand, reg2->rects, reg2->numRects * sizeof(RECT) );
+    }
+    else
+    {
+        WINEREGION tmp;
+
+        if (!init_region( &tmp, count )) return FALSE;
+        memcpy( tmp.rects, reg1->rects, reg1->numRects * sizeof(RECT) );
+        memcpy( tmp.rects + reg1->numRects, reg2->rects, reg2->numRects * sizeof(RECT) );
+        HeapFree( GetProcessHeap(), 0, newReg->rects );
+        newReg->rects = tmp.rects;
+        newReg->size  = tmp.size;
+    }
+    newReg->numRects = count;
+    REGION_Coalesce( newReg, prevBand, curBand );
+    newReg->extents = extents;
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_UnionRegion
  */
@@ -2098,6 +2175,14 @@ static BOOL REGION_UnionRegion(WINEREGION *newReg, WINEREGION *reg1, WINEREGION
 	return ret;
     }
 
+    /*
+     * The regions don't overlap vertically
+     */
+    if (reg2->extents.top >= reg1->extents.bottom)
+        return REGION_AppendRegion(newReg, reg1, reg2);
+    if (reg1->extents.top >= reg2->extents.bottom)
+        return REGION_AppendRegion(newReg, reg2, reg1);
+
     if ((ret = REGION_RegionOp (newReg, reg1, reg2, REGION_UnionO, REGION_UnionNonO, REGION_UnionNonO)))
     {
         newReg->extents.left = min(reg1->extents.left, reg2->extents.left);
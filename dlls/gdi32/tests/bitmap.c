@@ -3561,6 +3561,187 @@ static void test_StretchDIBits(void)
     DeleteDC(hdcScreen);
 }
 
+static DWORD blend_test_seed;
+
+static DWORD blend_test_rand(void)
+{
+    blend_test_seed = blend_test_seed * 1103515245 + 12345;
+    return blend_test_seed >> 8;
+}
+
+static void test_GdiAlphaBlend_widths(void)
+{
+    static const struct
+    {
+        BYTE constant_alpha;
+        BYTE format;
+        BOOL premultiplied;
+    }
+    blend_tests[] =
+    {
+        { 255, AC_SRC_ALPHA, TRUE },
+        { 0x80, AC_SRC_ALPHA, TRUE },
+        { 0x01, AC_SRC_ALPHA, TRUE },
+        { 255, AC_SRC_ALPHA, FALSE },  /* channels larger than alpha overflow */
+        { 0xc0, AC_SRC_ALPHA, FALSE },
+        { 0x80, 0, FALSE },
+        { 0, 0, FALSE },
+    };
+    static const DWORD rops[] = { SRCCOPY, SRCINVERT, SRCAND, SRCPAINT, NOTSRCCOPY, SRCERASE };
+    char bmibuf[sizeof(BITMAPINFO) + 256 * sizeof(RGBQUAD)];
+    BITMAPINFO *bmi = (BITMAPINFO *)bmibuf;
+    DWORD *src_bits, *dst_bits, *ref_bits;
+    HBITMAP bmp_src, bmp_dst, bmp_ref, old_src, old_dst, old_ref;
+    BLENDFUNCTION blend;
+    HDC hdc_src, hdc_dst, hdc_ref;
+    HBRUSH brush, old_brush;
+    int i, j, width, offset, src_x, dst_x;
+    BOOL ret;
+
+    if (!pGdiAlphaBlend)
+    {
+        win_skip("GdiAlphaBlend() is not implemented\n");
+        return;
+    }
+
+    memset( bmi, 0, sizeof(bmibuf) );
+    bmi->bmiHeader.biSize = sizeof(bmi->bmiHeader);
+    bmi->bmiHeader.biWidth = 24;
+    bmi->bmiHeader.biHeight = 1;
+    bmi->bmiHeader.biBitCount = 32;
+    bmi->bmiHeader.biPlanes = 1;
+    bmi->bmiHeader.biCompression = BI_RGB;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+    hdc_ref = CreateCompatibleDC( 0 );
+    bmp_src = CreateDIBSection( hdc_src, bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    bmp_dst = CreateDIBSection( hdc_dst, bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    bmp_ref = CreateDIBSection( hdc_ref, bmi, DIB_RGB_COLORS, (void **)&ref_bits, NULL, 0 );
+    old_src = SelectObject( hdc_src, bmp_src );
+    old_dst = SelectObject( hdc_dst, bmp_dst );
+    old_ref = SelectObject( hdc_ref, bmp_ref );
+
+    blend.BlendOp = AC_SRC_OVER;
+    blend.BlendFlags = 0;
+    blend.SourceConstantAlpha = 255;
+    blend.AlphaFormat = AC_SRC_ALPHA;
+
+    /* opaque and fully transparent pixels give exact results for any width */
+    for (width = 1; width <= 16; width++)
+    {
+        for (i = 0; i < 16; i++)
+        {
+            src_bits[i] = (i % 3) ? 0xff102030 + i : 0;
+            dst_bits[i] = 0x01020304 * (i + 1);
+        }
+        ret = pGdiAlphaBlend( hdc_dst, 0, 0, width, 1, hdc_src, 0, 0, width, 1, blend );
+        ok( ret, "GdiAlphaBlend failed err %u\n", GetLastError() );
+        for (i = 0; i < 16; i++)
+        {
+            DWORD expect = (i < width && (i % 3)) ? 0xff102030 + i : 0x01020304 * (i + 1);
+            ok( dst_bits[i] == expect, "%d/%d: got %08x expected %08x\n", width, i, dst_bits[i], expect );
+        }
+    }
+
+    /* Partial alpha: blending a whole span must give the same result as blending
+     * each of its pixels on its own, whatever the width and alignment. */
+    for (j = 0; j < sizeof(blend_tests) / sizeof(blend_tests[0]); j++)
+    {
+        blend.SourceConstantAlpha = blend_tests[j].constant_alpha;
+        blend.AlphaFormat = blend_tests[j].format;
+        blend_test_seed = j;
+
+        for (offset = 0; offset < 4; offset++)
+        {
+            for (width = 1; width <= 16; width++)
+            {
+                src_x = offset;
+                dst_x = (offset * 3 + 1) % 4;
+                for (i = 0; i < 24; i++)
+                {
+                    DWORD alpha = blend_test_rand() & 0xff, color = blend_test_rand() & 0xffffff;
+
+                    if (blend_tests[j].premultiplied)
+                        color = (((color & 0xff) * alpha / 255) |
+                                 (((color >> 8) & 0xff) * alpha / 255) << 8 |
+                                 (((color >> 16) & 0xff) * alpha / 255) << 16);
+                    src_bits[i] = alpha << 24 | color;
+                    dst_bits[i] = ref_bits[i] = blend_test_rand() ^ blend_test_rand() << 8;
+                }
+
+                ret = pGdiAlphaBlend( hdc_dst, dst_x, 0, width, 1, hdc_src, src_x, 0, width, 1, blend );
+                ok( ret, "GdiAlphaBlend failed err %u\n", GetLastError() );
+                for (i = 0; i < width; i++)
+                    pGdiAlphaBlend( hdc_ref, dst_x + i, 0, 1, 1, hdc_src, src_x + i, 0, 1, 1, blend );
+
+                for (i = 0; i < 24; i++)
+                    ok( dst_bits[i] == ref_bits[i], "%d: %d/%d/%d: got %08x expected %08x\n",
+                        j, offset, width, i, dst_bits[i], ref_bits[i] );
+            }
+        }
+    }
+
+    /* same for the raster operations */
+    for (j = 0; j < sizeof(rops) / sizeof(rops[0]); j++)
+    {
+        for (offset = 0; offset < 4; offset++)
+        {
+            for (width = 1; width <= 16; width++)
+            {
+                src_x = offset;
+                dst_x = (offset * 3 + 1) % 4;
+                for (i = 0; i < 24; i++)
+                {
+                    src_bits[i] = blend_test_rand() ^ blend_test_rand() << 8;
+                    dst_bits[i] = ref_bits[i] = blend_test_rand() ^ blend_test_rand() << 8;
+                }
+
+                ret = BitBlt( hdc_dst, dst_x, 0, width, 1, hdc_src, src_x, 0, rops[j] );
+                ok( ret, "BitBlt failed err %u\n", GetLastError() );
+                for (i = 0; i < width; i++)
+                    BitBlt( hdc_ref, dst_x + i, 0, 1, 1, hdc_src, src_x + i, 0, rops[j] );
+
+                for (i = 0; i < 24; i++)
+                    ok( dst_bits[i] == ref_bits[i], "rop %08x: %d/%d/%d: got %08x expected %08x\n",
+                        rops[j], offset, width, i, dst_bits[i], ref_bits[i] );
+            }
+        }
+    }
+
+    brush = CreateSolidBrush( RGB( 0x12, 0x34, 0x56 ));
+    old_brush = SelectObject( hdc_dst, brush );
+    for (offset = 0; offset < 4; offset++)
+    {
+        for (width = 1; width <= 16; width++)
+        {
+            for (i = 0; i < 24; i++) dst_bits[i] = ref_bits[i] = blend_test_rand() ^ blend_test_rand() << 8;
+
+            PatBlt( hdc_dst, offset, 0, width, 1, PATINVERT );
+            PatBlt( hdc_dst, offset + 1, 0, width, 1, DSTINVERT );
+            for (i = 0; i < 24; i++)
+            {
+                if (i >= offset && i < offset + width) ref_bits[i] ^= 0x123456;
+                if (i >= offset + 1 && i < offset + 1 + width) ref_bits[i] = ~ref_bits[i];
+                ok( dst_bits[i] == ref_bits[i], "%d/%d/%d: got %08x expected %08x\n",
+                    offset, width, i, dst_bits[i], ref_bits[i] );
+            }
+        }
+    }
+    SelectObject( hdc_dst, old_brush );
+    DeleteObject( brush );
+
+    SelectObject( hdc_src, old_src );
+    SelectObject( hdc_dst, old_dst );
+    SelectObject( hdc_ref, old_ref );
+    DeleteObject( bmp_src );
+    DeleteObject( bmp_dst );
+    DeleteObject( bmp_ref );
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+    DeleteDC( hdc_ref );
+}
+
 static void test_GdiAlphaBlend(void)
 {
     HDC hdcNull;
@@ -5616,6 +5797,92 @@ static void test_SetDIBitsToDevice_RLE8(void)
     HeapFree( GetProcessHeap(), 0, info );
 }
 
+static DWORD WINAPI batch_limit_thread( void *arg )
+{
+    DWORD limit, prev;
+
+    /* the limit set by the main thread doesn't apply here */
+    limit = GdiGetBatchLimit();
+    ok( limit != 10, "got %u\n", limit );
+
+    prev = GdiSetBatchLimit( 5 );
+    ok( prev == limit, "got %u\n", prev );
+    limit = GdiGetBatchLimit();
+    ok( limit == 5, "got %u\n", limit );
+    return 0;
+}
+
+static void test_GdiSetBatchLimit(void)
+{
+    BITMAPINFO info;
+    DWORD *bits, limit, prev;
+    HBITMAP dib;
+    HBRUSH brush;
+    COLORREF color;
+    HDC hdc = CreateCompatibleDC( 0 );
+    HANDLE thread;
+    int i;
+
+    memset( &info, 0, sizeof(info) );
+    info.bmiHeader.biSize        = sizeof(info.bmiHeader);
+    info.bmiHeader.biWidth       = 8;
+    info.bmiHeader.biHeight      = -8;
+    info.bmiHeader.biPlanes      = 1;
+    info.bmiHeader.biBitCount    = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    dib = CreateDIBSection( NULL, &info, DIB_RGB_COLORS, (void **)&bits, NULL, 0 );
+    ok( dib != NULL, "CreateDIBSection failed\n" );
+    memset( bits, 0xaa, 64 * 4 );
+    SelectObject( hdc, dib );
+    brush = CreateSolidBrush( RGB( 0x11, 0x22, 0x33 ));
+    SelectObject( hdc, brush );
+
+    prev = GdiSetBatchLimit( 10 );
+    ok( prev != 0, "got %u\n", prev );
+    limit = GdiGetBatchLimit();
+    ok( limit == 10, "got %u\n", limit );
+
+    thread = CreateThread( NULL, 0, batch_limit_thread, NULL, 0, NULL );
+    ok( thread != NULL, "CreateThread failed\n" );
+    WaitForSingleObject( thread, INFINITE );
+    CloseHandle( thread );
+    limit = GdiGetBatchLimit();
+    ok( limit == 10, "got %u\n", limit );
+
+    for (i = 0; i < 8; i++) PatBlt( hdc, i, 0, 1, 4, PATCOPY );
+    PatBlt( hdc, 0, 4, 8, 4, BLACKNESS );
+    PatBlt( hdc, 0, 6, 8, 2, DSTINVERT );
+
+    /* reading through the DC doesn't need a flush */
+    color = GetPixel( hdc, 3, 2 );
+    ok( color == RGB( 0x11, 0x22, 0x33 ), "got %08x\n", color );
+    color = GetPixel( hdc, 3, 5 );
+    ok( color == RGB( 0, 0, 0 ), "got %08x\n", color );
+
+    PatBlt( hdc, 2, 2, 4, 1, WHITENESS );
+    GdiFlush();
+    for (i = 0; i < 64; i++)
+    {
+        DWORD expect;
+
+        if (i / 8 == 2 && i % 8 >= 2 && i % 8 < 6) expect = 0xffffff;
+        else if (i < 32) expect = 0x112233;
+        else if (i < 48) expect = 0;
+        else expect = 0xffffff;
+        ok( (bits[i] & 0xffffff) == expect, "%d: got %08x\n", i, bits[i] );
+    }
+
+    limit = GdiSetBatchLimit( prev );
+    ok( limit == 10, "got %u\n", limit );
+    limit = GdiGetBatchLimit();
+    ok( limit == prev, "got %u\n", limit );
+
+    DeleteDC( hdc );
+    DeleteObject( dib );
+    DeleteObject( brush );
+}
+
 START_TEST(bitmap)
 {
     HMODULE hdll;
@@ -5645,6 +5912,7 @@ START_TEST(bitmap)
     test_StretchBlt();
     test_StretchDIBits();
     test_GdiAlphaBlend();
+    test_GdiAlphaBlend_widths();
     test_GdiGradientFill();
     test_32bit_ddb();
     test_bitmapinfoheadersize();
@@ -5660,4 +5928,5 @@ START_TEST(bitmap)
     test_SetDIBits_RLE8();
     test_SetDIBitsToDevice();
     test_SetDIBitsToDevice_RLE8();
+    test_GdiSetBatchLimit();
 }
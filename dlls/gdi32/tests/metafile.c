@@ -1870,6 +1870,65 @@ static void test_emf_DCBrush(void)
     ok( ret, "DeleteObject(HPEN) error %d\n", GetLastError());
 }
 
+static void test_emf_brush_reuse(void)
+{
+    static const COLORREF colors[] = { RGB(0xff,0,0), RGB(0,0,0xff), RGB(0xff,0,0), RGB(0,0xff,0),
+                                       RGB(0,0,0xff), RGB(0,0,0xff), RGB(0xff,0,0), RGB(0,0xff,0) };
+    BITMAPINFO info;
+    HDC hdcBitmap, hdcMetafile;
+    HENHMETAFILE hMetafile;
+    HBITMAP hBitmap, hOldBitmap;
+    HBRUSH hBrush, hOldBrush;
+    COLORREF color;
+    RECT rc;
+    void *bits;
+    BOOL ret;
+    int i;
+
+    hdcBitmap = CreateCompatibleDC( 0 );
+    memset( &info, 0, sizeof(info) );
+    info.bmiHeader.biSize     = sizeof(info.bmiHeader);
+    info.bmiHeader.biWidth    = 32;
+    info.bmiHeader.biHeight   = -8;
+    info.bmiHeader.biPlanes   = 1;
+    info.bmiHeader.biBitCount = 32;
+    hBitmap = CreateDIBSection( hdcBitmap, &info, DIB_RGB_COLORS, &bits, NULL, 0 );
+    hOldBitmap = SelectObject( hdcBitmap, hBitmap );
+
+    hdcMetafile = CreateEnhMetaFileA( hdcBitmap, NULL, NULL, NULL );
+    ok( hdcMetafile != 0, "CreateEnhMetaFileA failed\n" );
+
+    /* each brush is created, used and deleted, so the same slots and colors come back */
+    for (i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+    {
+        hBrush = CreateSolidBrush( colors[i] );
+        hOldBrush = SelectObject( hdcMetafile, hBrush );
+        ret = PatBlt( hdcMetafile, i * 4, 0, 4, 8, PATCOPY );
+        ok( ret, "PatBlt failed\n" );
+        SelectObject( hdcMetafile, hOldBrush );
+        DeleteObject( hBrush );
+    }
+
+    hMetafile = CloseEnhMetaFile( hdcMetafile );
+    ok( hMetafile != 0, "CloseEnhMetaFile failed\n" );
+
+    SetRect( &rc, 0, 0, 32, 8 );
+    ret = PlayEnhMetaFile( hdcBitmap, hMetafile, &rc );
+    ok( ret, "PlayEnhMetaFile failed\n" );
+
+    for (i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+    {
+        color = GetPixel( hdcBitmap, i * 4 + 2, 4 );
+        ok( color == colors[i], "%d: got %08x\n", i, color );
+    }
+
+    ret = DeleteEnhMetaFile( hMetafile );
+    ok( ret, "DeleteEnhMetaFile error %d\n", GetLastError() );
+    SelectObject( hdcBitmap, hOldBitmap );
+    DeleteObject( hBitmap );
+    DeleteDC( hdcBitmap );
+}
+
 /* Test a blank metafile.  May be used as a template for new tests. */
 
 static void test_mf_Blank(void)
@@ -3386,6 +3445,7 @@ START_TEST(metafile)
     test_emf_ExtTextOut_on_path();
     test_emf_clipping();
     test_emf_polybezier();
+    test_emf_brush_reuse();
 
     /* For win-format metafiles (mfdrv) */
     test_mf_SaveDC();
@@ -109,6 +109,16 @@ static inline ARGB color_over(ARGB bg, ARGB fg)
     if (bg_alpha == 0) return fg;
 
     a = bg_alpha + fg_alpha;
+
+    if (a == 0xff)
+    {
+        /* opaque background, avoid the divisions by a variable */
+        b = ((bg&0xff)*bg_alpha + (fg&0xff)*fg_alpha)/0xff;
+        g = (((bg>>8)&0xff)*bg_alpha + ((fg>>8)&0xff)*fg_alpha)/0xff;
+        r = (((bg>>16)&0xff)*bg_alpha + ((fg>>16)&0xff)*fg_alpha)/0xff;
+        return 0xff000000|(r<<16)|(g<<8)|b;
+    }
+
     b = ((bg&0xff)*bg_alpha + (fg&0xff)*fg_alpha)/a;
     g = (((bg>>8)&0xff)*bg_alpha + ((fg>>8)&0xff)*fg_alpha)/a;
     r = (((bg>>16)&0xff)*bg_alpha + ((fg>>16)&0xff)*fg_alpha)/a;
@@ -360,9 +360,31 @@ static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_
     GpBitmap *dst_bitmap = (GpBitmap*)graphics->image;
     INT x, y;
 
-    for (x=0; x<src_width; x++)
+    if (dst_bitmap->bits &&
+        (dst_bitmap->format == PixelFormat32bppARGB || dst_bitmap->format == PixelFormat32bppRGB))
     {
-        for (y=0; y<src_height; y++)
+        /* blend straight into the bits, clipping to the bitmap like Get/SetPixel would */
+        INT left = max(dst_x, 0), right = min(dst_x + src_width, dst_bitmap->width);
+        INT top = max(dst_y, 0), bottom = min(dst_y + src_height, dst_bitmap->height);
+
+        for (y=top; y<bottom; y++)
+        {
+            const ARGB *src_row = (const ARGB*)(src + src_stride * (y - dst_y)) - dst_x;
+            ARGB *dst_row = (ARGB*)(dst_bitmap->bits + dst_bitmap->stride * y);
+
+            if (dst_bitmap->format == PixelFormat32bppARGB)
+                for (x=left; x<right; x++)
+                    dst_row[x] = color_over(dst_row[x], src_row[x]);
+            else
+                for (x=left; x<right; x++)
+                    dst_row[x] = color_over(dst_row[x] | 0xff000000, src_row[x]) & 0xffffff;
+        }
+        return Ok;
+    }
+
+    for (y=0; y<src_height; y++)
+    {
+        for (x=0; x<src_width; x++)
         {
             ARGB dst_color, src_color;
             GdipBitmapGetPixel(dst_bitmap, x+dst_x, y+dst_y, &dst_color);
@@ -1036,8 +1058,8 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
     {
         int x, y;
         GpSolidFill *fill = (GpSolidFill*)brush;
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
+        for (y=0; y<fill_area->Height; y++)
+            for (x=0; x<fill_area->Width; x++)
                 argb_pixels[x + y*cdwStride] = fill->color;
         return Ok;
     }
@@ -1050,8 +1072,8 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
         if (get_hatch_data(fill->hatchstyle, &hatch_data) != Ok)
             return NotImplemented;
 
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
+        for (y=0; y<fill_area->Height; y++)
+            for (x=0; x<fill_area->Width; x++)
             {
                 int hx, hy;
 
@@ -2284,6 +2284,38 @@ static void test_srwlock_example(void)
     trace("number of total exclusive accesses is %d\n", srwlock_protected_value);
 }
 
+static DWORD apc_order[8];
+static DWORD apc_count, nested_apc_ret;
+
+static void CALLBACK order_apc(ULONG_PTR arg)
+{
+    apc_order[apc_count++] = arg;
+    /* a nested alertable wait runs the APCs that are still queued */
+    if (arg == 1) nested_apc_ret = SleepEx(0, TRUE);
+}
+
+static void test_apc_order(void)
+{
+    DWORD ret, i;
+
+    apc_count = 0;
+    for (i = 1; i <= 5; i++)
+    {
+        ret = QueueUserAPC(order_apc, GetCurrentThread(), i);
+        ok(ret, "QueueUserAPC failed: %u\n", GetLastError());
+    }
+
+    ret = SleepEx(0, TRUE);
+    ok(ret == WAIT_IO_COMPLETION, "SleepEx returned %u\n", ret);
+    ok(nested_apc_ret == WAIT_IO_COMPLETION, "nested SleepEx returned %u\n", nested_apc_ret);
+    ok(apc_count == 5, "got %u APC calls\n", apc_count);
+    for (i = 0; i < apc_count; i++)
+        ok(apc_order[i] == i + 1, "APC %u: got %u\n", i, apc_order[i]);
+
+    ret = SleepEx(0, TRUE);
+    ok(!ret, "SleepEx returned %u\n", ret);
+}
+
 START_TEST(sync)
 {
     HMODULE hdll = GetModuleHandleA("kernel32.dll");
@@ -2328,4 +2360,5 @@ START_TEST(sync)
     test_condvars_consumer_producer();
     test_srwlock_base();
     test_srwlock_example();
+    test_apc_order();
 }
@@ -40,6 +40,8 @@ static UINT   (WINAPI *pResetWriteWatch)(LPVOID,SIZE_T);
 static NTSTATUS (WINAPI *pNtAreMappedFilesTheSame)(PVOID,PVOID);
 static NTSTATUS (WINAPI *pNtMapViewOfSection)(HANDLE, HANDLE, PVOID *, ULONG, SIZE_T, const LARGE_INTEGER *, SIZE_T *, ULONG, ULONG, ULONG);
 static DWORD (WINAPI *pNtUnmapViewOfSection)(HANDLE, PVOID);
+static SIZE_T (WINAPI *pGetLargePageMinimum)(void);
+static BOOL (WINAPI *pPrefetchVirtualMemory)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY, ULONG);
 
 /* ############################### */
 
@@ -2489,6 +2491,84 @@ static void test_shared_memory(int is_child)
     CloseHandle(mapping);
 }
 
+static void test_large_pages(void)
+{
+    WIN32_MEMORY_RANGE_ENTRY ranges[2];
+    TOKEN_PRIVILEGES privs;
+    SIZE_T large_page_size;
+    HANDLE token, mapping;
+    char *mem;
+    BOOL ret;
+
+    if (!pGetLargePageMinimum || !pPrefetchVirtualMemory)
+    {
+        win_skip("GetLargePageMinimum or PrefetchVirtualMemory not supported\n");
+        return;
+    }
+
+    large_page_size = pGetLargePageMinimum();
+    ok(!(large_page_size & (large_page_size - 1)), "large page size %lx is not a power of 2\n",
+       large_page_size);
+
+    mem = VirtualAlloc(NULL, 0x10000, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    ok(mem != NULL, "VirtualAlloc failed %u\n", GetLastError());
+
+    ranges[0].VirtualAddress = mem + 0x1234;
+    ranges[0].NumberOfBytes = 0x2000;
+    ranges[1].VirtualAddress = mem;
+    ranges[1].NumberOfBytes = 0x10000;
+    ret = pPrefetchVirtualMemory(GetCurrentProcess(), 2, ranges, 0);
+    ok(ret, "PrefetchVirtualMemory failed %u\n", GetLastError());
+    VirtualFree(mem, 0, MEM_RELEASE);
+
+    if (!large_page_size) return;
+
+    /* size is not a multiple of the large page size */
+    mem = VirtualAlloc(NULL, large_page_size + 0x1000, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                       PAGE_READWRITE);
+    ok(mem == NULL, "VirtualAlloc succeeded\n");
+
+    /* SeLockMemoryPrivilege is required and not enabled by default */
+    SetLastError(0xdeadbeef);
+    mem = VirtualAlloc(NULL, large_page_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                       PAGE_READWRITE);
+    ok(mem == NULL, "VirtualAlloc succeeded\n");
+    ok(GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "got %u\n", GetLastError());
+
+    SetLastError(0xdeadbeef);
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+                                 0, large_page_size, NULL);
+    ok(mapping == NULL, "CreateFileMappingA succeeded\n");
+    ok(GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "got %u\n", GetLastError());
+
+    privs.PrivilegeCount = 1;
+    privs.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES, &token) ||
+        !LookupPrivilegeValueA(NULL, SE_LOCK_MEMORY_NAME, &privs.Privileges[0].Luid) ||
+        !AdjustTokenPrivileges(token, FALSE, &privs, sizeof(privs), NULL, NULL) ||
+        GetLastError() == ERROR_NOT_ALL_ASSIGNED)
+    {
+        skip("cannot enable SE_LOCK_MEMORY_NAME privilege\n");
+        CloseHandle(token);
+        return;
+    }
+
+    mem = VirtualAlloc(NULL, large_page_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                       PAGE_READWRITE);
+    if (mem)
+    {
+        ok(!((ULONG_PTR)mem & (large_page_size - 1)), "%p is not aligned to large page size\n", mem);
+        mem[0] = mem[large_page_size - 1] = 1;
+        VirtualFree(mem, 0, MEM_RELEASE);
+    }
+    else skip("large pages not available, error %u\n", GetLastError());
+
+    privs.Privileges[0].Attributes = 0;
+    AdjustTokenPrivileges(token, FALSE, &privs, sizeof(privs), NULL, NULL);
+    CloseHandle(token);
+}
+
 START_TEST(virtual)
 {
     int argc;
@@ -2531,6 +2611,8 @@ START_TEST(virtual)
                                                        "NtAreMappedFilesTheSame" );
     pNtMapViewOfSection = (void *)GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtMapViewOfSection");
     pNtUnmapViewOfSection = (void *)GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtUnmapViewOfSection");
+    pGetLargePageMinimum = (void *)GetProcAddress(hkernel32, "GetLargePageMinimum");
+    pPrefetchVirtualMemory = (void *)GetProcAddress(hkernel32, "PrefetchVirtualMemory");
 
     test_shared_memory(0);
     test_mapping();
@@ -2547,4 +2629,5 @@ START_TEST(virtual)
     test_IsBadWritePtr();
     test_IsBadCodePtr();
     test_write_watch();
+    test_large_pages();
 }
@@ -335,7 +335,8 @@ HANDLE WINAPI CreateFileMappingW( HANDLE hFile, LPSECURITY_ATTRIBUTES sa,
                                   DWORD protect, DWORD size_high,
                                   DWORD size_low, LPCWSTR name )
 {
-    static const int sec_flags = SEC_FILE | SEC_IMAGE | SEC_RESERVE | SEC_COMMIT | SEC_NOCACHE;
+    static const DWORD sec_flags = (SEC_FILE | SEC_IMAGE | SEC_RESERVE | SEC_COMMIT |
+                                    SEC_NOCACHE | SEC_LARGE_PAGES);
 
     HANDLE ret;
     NTSTATUS status;
@@ -630,6 +631,21 @@ UINT WINAPI ResetWriteWatch( LPVOID base, SIZE_T size )
 }
 
 
+/***********************************************************************
+ *             PrefetchVirtualMemory   (KERNEL32.@)
+ */
+BOOL WINAPI PrefetchVirtualMemory( HANDLE process, ULONG_PTR count,
+                                   PWIN32_MEMORY_RANGE_ENTRY addresses, ULONG flags )
+{
+    NTSTATUS status;
+
+    status = NtSetInformationVirtualMemory( process, VmPrefetchInformation, count,
+                                            (PMEMORY_RANGE_ENTRY)addresses, &flags, sizeof(flags) );
+    if (status) SetLastError( RtlNtStatusToDosError(status) );
+    return !status;
+}
+
+
 /***********************************************************************
  *             IsBadReadPtr   (KERNEL32.@)
  *
@@ -57,6 +57,9 @@
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef HAVE_UTIME_H
 # include <utime.h>
 #endif
@@ -786,6 +789,31 @@ err:
 }
 
 
+#if defined(HAVE_PREADV) || defined(HAVE_PWRITEV)
+
+#if defined(IOV_MAX) && IOV_MAX < 256
+#define MAX_SEGMENT_IOV IOV_MAX
+#else
+#define MAX_SEGMENT_IOV 256
+#endif
+
+/* fill an iovec array with the remaining pages of a scatter/gather request */
+static int get_segments_iovec( struct iovec *iov, const FILE_SEGMENT_ELEMENT *segments,
+                               ULONG pos, ULONG length )
+{
+    int count;
+
+    for (count = 0; count < MAX_SEGMENT_IOV && length; count++, segments++, pos = 0)
+    {
+        iov[count].iov_base = (char *)segments->Buffer + pos;
+        iov[count].iov_len  = min( page_size - pos, length );
+        length -= iov[count].iov_len;
+    }
+    return count;
+}
+
+#endif  /* HAVE_PREADV || HAVE_PWRITEV */
+
 /******************************************************************************
  *  NtReadFileScatter   [NTDLL.@]
  *  ZwReadFileScatter   [NTDLL.@]
@@ -822,11 +850,22 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+#ifdef HAVE_PREADV
+        struct iovec iov[MAX_SEGMENT_IOV];
+        int count = get_segments_iovec( iov, segments, pos, length );
+
+        /* read as many segments as possible in a single system call */
+        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            result = preadv( unix_handle, iov, count, offset->QuadPart + total );
+        else
+            result = readv( unix_handle, iov, count );
+#else
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
             result = pread( unix_handle, (char *)segments->Buffer + pos,
                             page_size - pos, offset->QuadPart + total );
         else
             result = read( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+#endif
 
         if (result == -1)
         {
@@ -841,11 +880,9 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     send_completion = cvalue != 0;
@@ -1224,11 +1261,22 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+#ifdef HAVE_PWRITEV
+        struct iovec iov[MAX_SEGMENT_IOV];
+        int count = get_segments_iovec( iov, segments, pos, length );
+
+        /* write as many segments as possible in a single system call */
+        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            result = pwritev( unix_handle, iov, count, offset->QuadPart + total );
+        else
+            result = writev( unix_handle, iov, count );
+#else
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
             result = pwrite( unix_handle, (char *)segments->Buffer + pos,
                              page_size - pos, offset->QuadPart + total );
         else
             result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+#endif
 
         if (result == -1)
         {
@@ -1248,11 +1296,9 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     send_completion = cvalue != 0;
@@ -76,6 +76,7 @@
 #include "wine/library.h"
 #include "wine/server.h"
 #include "wine/debug.h"
+#include "wine/exception.h"
 #include "ntdll_misc.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(server);
@@ -562,6 +563,73 @@ static BOOL invoke_apc( const apc_call_t *call, apc_result_t *result )
 }
 
 
+/* APCs returned by a select request */
+struct select_apcs
+{
+    const select_apc_call_t *calls;   /* APC calls */
+    unsigned int             count;   /* number of calls */
+    unsigned int             pos;     /* next call to run */
+    struct select_apcs      *prev;    /* APCs of the outer select call */
+};
+
+#define MAX_SELECT_APCS 16
+
+/***********************************************************************
+ *              invoke_select_apcs
+ *
+ * Invoke the remaining APCs of a select reply, and store the results that
+ * need to be returned to the server. Return TRUE if a user APC has been run.
+ */
+static BOOL invoke_select_apcs( struct select_apcs *apcs, select_apc_result_t *results,
+                                unsigned int *nb_results )
+{
+    BOOL user_apc = FALSE;
+
+    while (apcs->pos < apcs->count)
+    {
+        const select_apc_call_t *call = &apcs->calls[apcs->pos++];
+
+        if (invoke_apc( &call->call, &results[*nb_results].result )) user_apc = TRUE;
+        if (call->handle)
+        {
+            results[*nb_results].handle = call->handle;
+            results[*nb_results].__pad  = 0;
+            (*nb_results)++;
+        }
+    }
+    return user_apc;
+}
+
+
+/***********************************************************************
+ *              select_apcs_finally
+ *
+ * Restore the APCs of the outer select call, and queue again the APCs
+ * that were not run because an exception unwound the user APC.
+ */
+static void CALLBACK select_apcs_finally( BOOL normal )
+{
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+    struct select_apcs *apcs = thread_data->select_apcs;
+
+    thread_data->select_apcs = apcs->prev;
+    if (normal) return;
+
+    while (apcs->pos < apcs->count)
+    {
+        const apc_call_t *call = &apcs->calls[apcs->pos++].call;
+
+        if (call->type == APC_USER)
+            NtQueueApcThread( GetCurrentThread(), wine_server_get_ptr( call->user.func ),
+                              call->user.args[0], call->user.args[1], call->user.args[2] );
+        else if (call->type == APC_TIMER)
+            NtQueueApcThread( GetCurrentThread(), wine_server_get_ptr( call->timer.func ),
+                              call->timer.arg, (DWORD)call->timer.time,
+                              (DWORD)(call->timer.time >> 32) );
+    }
+}
+
+
 /***********************************************************************
  *              server_select
  */
@@ -571,38 +639,59 @@ unsigned int server_select( const select_op_t *select_op, data_size_t size, UINT
     unsigned int ret;
     int cookie;
     BOOL user_apc = FALSE;
-    obj_handle_t apc_handle = 0;
-    apc_call_t call;
-    apc_result_t result;
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+    struct select_apcs apcs;
+    select_apc_call_t calls[MAX_SELECT_APCS];
+    select_apc_result_t results[MAX_SELECT_APCS];
+    unsigned int nb_results = 0;
     timeout_t abs_timeout = timeout ? timeout->QuadPart : TIMEOUT_INFINITE;
 
-    memset( &result, 0, sizeof(result) );
+    /* waiting alertably from a user APC, first run the remaining APCs of its batch */
+    if ((flags & SELECT_ALERTABLE) && thread_data->select_apcs &&
+        invoke_select_apcs( thread_data->select_apcs, results, &nb_results ))
+    {
+        abs_timeout = 0;
+        user_apc = TRUE;
+    }
 
     for (;;)
     {
         SERVER_START_REQ( select )
         {
-            req->flags    = flags;
-            req->cookie   = wine_server_client_ptr( &cookie );
-            req->prev_apc = apc_handle;
-            req->timeout  = abs_timeout;
-            wine_server_add_data( req, &result, sizeof(result) );
+            req->flags       = flags;
+            req->cookie      = wine_server_client_ptr( &cookie );
+            req->timeout     = abs_timeout;
+            req->result_size = nb_results * sizeof(results[0]);
+            wine_server_add_data( req, results, nb_results * sizeof(results[0]) );
             wine_server_add_data( req, select_op, size );
+            wine_server_set_reply( req, calls, sizeof(calls) );
             ret = wine_server_call( req );
             abs_timeout = reply->timeout;
-            apc_handle  = reply->apc_handle;
-            call        = reply->call;
+            apcs.count  = wine_server_reply_size( reply ) / sizeof(calls[0]);
         }
         SERVER_END_REQ;
         if (ret == STATUS_PENDING) ret = wait_select_reply( &cookie );
         if (ret != STATUS_USER_APC) break;
-        if (invoke_apc( &call, &result ))
+
+        apcs.calls = calls;
+        apcs.pos   = 0;
+        nb_results = 0;
+        if (apcs.count && !calls[0].handle)
         {
-            /* if we ran a user apc we have to check once more if an object got signaled,
-             * but we don't want to wait */
-            abs_timeout = 0;
-            user_apc = TRUE;
+            /* user APCs may wait again, the nested wait will run the remaining ones */
+            apcs.prev = thread_data->select_apcs;
+            thread_data->select_apcs = &apcs;
+            __TRY
+            {
+                if (invoke_select_apcs( &apcs, results, &nb_results )) user_apc = TRUE;
+            }
+            __FINALLY( select_apcs_finally )
         }
+        else if (invoke_select_apcs( &apcs, results, &nb_results )) user_apc = TRUE;
+
+        /* if we ran a user apc we have to check once more if an object got signaled,
+         * but we don't want to wait */
+        if (user_apc) abs_timeout = 0;
 
         /* don't signal multiple times */
         if (size >= sizeof(select_op->signal_and_wait) && select_op->op == SELECT_SIGNAL_AND_WAIT)
@@ -325,6 +325,7 @@ HANDLE thread_init(void)
     user_shared_data->u.TickCount.High2Time = user_shared_data->u.TickCount.High1Time;
     user_shared_data->TickCountLowDeprecated = user_shared_data->u.TickCount.LowPart;
     user_shared_data->TickCountMultiplier = 1 << 24;
+    user_shared_data->LargePageMinimum = virtual_get_large_page_size();
 
     fill_cpu_info();
 
@@ -153,6 +153,7 @@ static void *preload_reserve_start;
 static void *preload_reserve_end;
 static BOOL use_locks;
 static BOOL force_exec_prot;  /* whether to force PROT_EXEC on all PROT_READ mmaps */
+static size_t large_page_size;  /* size of a large page, 0 if not supported */
 
 
 /***********************************************************************
@@ -1057,7 +1058,8 @@ static NTSTATUS stat_mapping_file( struct file_view *view, struct stat *st )
  * Map an executable (PE format) image into memory.
  */
 static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_size, SIZE_T mask,
-                           SIZE_T header_size, int shared_fd, HANDLE dup_mapping, unsigned int map_vprot, PVOID *addr_ptr )
+                           SIZE_T header_size, int shared_fd, int image_fd, HANDLE dup_mapping,
+                           unsigned int map_vprot, PVOID *addr_ptr )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -1100,12 +1102,22 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
     status = STATUS_INVALID_IMAGE_FORMAT;  /* generic error */
     if (!st.st_size) goto error;
     header_size = min( header_size, st.st_size );
-    if (map_file_into_view( view, fd, 0, header_size, 0, VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
-                            !dup_mapping ) != STATUS_SUCCESS) goto error;
+    header_end = ptr + ROUND_SIZE( 0, header_size );
+    if (image_fd != -1)
+    {
+        /* the image layout file is zero-filled past the end of the headers */
+        if (map_file_into_view( view, image_fd, 0, min( header_end - ptr, total_size ), 0,
+                                VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY, FALSE ) != STATUS_SUCCESS)
+            goto error;
+    }
+    else
+    {
+        if (map_file_into_view( view, fd, 0, header_size, 0, VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
+                                !dup_mapping ) != STATUS_SUCCESS) goto error;
+        memset( ptr + header_size, 0, header_end - (ptr + header_size) );
+    }
     dos = (IMAGE_DOS_HEADER *)ptr;
     nt = (IMAGE_NT_HEADERS *)(ptr + dos->e_lfanew);
-    header_end = ptr + ROUND_SIZE( 0, header_size );
-    memset( ptr + header_size, 0, header_end - (ptr + header_size) );
     if ((char *)(nt + 1) > header_end) goto error;
     header_start = (char*)&nt->OptionalHeader+nt->FileHeader.SizeOfOptionalHeader;
     if (nt->FileHeader.NumberOfSections > sizeof(sections)/sizeof(*sections)) goto error;
@@ -1210,14 +1222,34 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
 
         if (!sec->PointerToRawData || !file_size) continue;
 
-        /* Note: if the section is not aligned properly map_file_into_view will magically
-         *       fall back to read(), so we don't need to check anything here.
-         */
         end = file_start + file_size;
         if (sec->PointerToRawData >= st.st_size ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
-            end < file_start ||
-            map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
+            end < file_start)
+        {
+            ERR_(module)( "Could not map section %.8s, file probably truncated\n", sec->Name );
+            goto error;
+        }
+
+        if (image_fd != -1)
+        {
+            /* the image layout file has the section at its virtual address, zero-filled
+             * up to the next page, so it can be mapped without dirtying any page */
+            end = min( ROUND_SIZE( 0, file_size ), map_size );
+            if (map_file_into_view( view, image_fd, sec->VirtualAddress, end, sec->VirtualAddress,
+                                    VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
+                                    FALSE ) != STATUS_SUCCESS)
+            {
+                ERR_(module)( "Could not map section %.8s from image file\n", sec->Name );
+                goto error;
+            }
+            continue;
+        }
+
+        /* Note: if the section is not aligned properly map_file_into_view will magically
+         *       fall back to read(), so we don't need to check anything here.
+         */
+        if (map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
                                 VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
                                 !dup_mapping ) != STATUS_SUCCESS)
         {
@@ -1339,6 +1371,72 @@ static int alloc_virtual_heap( void *base, size_t size, void *arg )
     return (*heap_base != (void *)-1);
 }
 
+/***********************************************************************
+ *           init_large_page_size
+ *
+ * Retrieve the huge page size of the host; large pages are implemented
+ * with transparent huge pages so they require madvise support.
+ */
+static void init_large_page_size(void)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    char buffer[80];
+    unsigned long size;
+    FILE *f;
+
+    if (!(f = fopen( "/proc/meminfo", "r" ))) return;
+    while (fgets( buffer, sizeof(buffer), f ))
+    {
+        if (sscanf( buffer, "Hugepagesize: %lu kB", &size ) != 1) continue;
+        if (size && !((size * 1024) & ((size * 1024) - 1))) large_page_size = size * 1024;
+        break;
+    }
+    fclose( f );
+    TRACE( "large page size %lx\n", (unsigned long)large_page_size );
+#endif
+}
+
+
+/***********************************************************************
+ *           check_lock_memory_privilege
+ *
+ * Large pages can't be paged out, so they require SeLockMemoryPrivilege
+ * to be enabled in the process token.
+ */
+static NTSTATUS check_lock_memory_privilege(void)
+{
+    PRIVILEGE_SET privs;
+    BOOLEAN has_privilege = FALSE;
+    HANDLE token;
+    NTSTATUS status;
+
+    if ((status = NtOpenProcessToken( NtCurrentProcess(), TOKEN_QUERY, &token ))) return status;
+    privs.PrivilegeCount = 1;
+    privs.Control = PRIVILEGE_SET_ALL_NECESSARY;
+    privs.Privilege[0].Luid.LowPart = SE_LOCK_MEMORY_PRIVILEGE;
+    privs.Privilege[0].Luid.HighPart = 0;
+    privs.Privilege[0].Attributes = 0;
+    status = NtPrivilegeCheck( token, &privs, &has_privilege );
+    NtClose( token );
+    if (status) return status;
+    return has_privilege ? STATUS_SUCCESS : STATUS_PRIVILEGE_NOT_HELD;
+}
+
+
+/***********************************************************************
+ *           set_large_pages
+ *
+ * Ask the kernel to back the specified range with huge pages.
+ */
+static void set_large_pages( void *base, size_t size )
+{
+#ifdef MADV_HUGEPAGE
+    if (madvise( base, size, MADV_HUGEPAGE ) == -1)
+        WARN( "no huge pages for %p-%p: %s\n", base, (char *)base + size, strerror(errno) );
+#endif
+}
+
+
 /***********************************************************************
  *           virtual_init
  */
@@ -1358,6 +1456,7 @@ void virtual_init(void)
     while ((1 << page_shift) != page_size) page_shift++;
     user_space_limit = working_set_limit = address_space_limit = (void *)~page_mask;
 #endif  /* page_mask */
+    init_large_page_size();
     if ((preload = getenv("WINEPRELOADRESERVE")))
     {
         unsigned long start, end;
@@ -1412,6 +1511,15 @@ void virtual_get_system_info( SYSTEM_BASIC_INFORMATION *info )
 }
 
 
+/***********************************************************************
+ *           virtual_get_large_page_size
+ */
+SIZE_T virtual_get_large_page_size(void)
+{
+    return large_page_size;
+}
+
+
 /***********************************************************************
  *           virtual_create_builtin_view
  */
@@ -1887,12 +1995,23 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
     /* Compute the alloc type flags */
 
     if (!(type & (MEM_COMMIT | MEM_RESERVE | MEM_RESET)) ||
-        (type & ~(MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET)))
+        (type & ~(MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET | MEM_LARGE_PAGES)))
     {
         WARN("called with wrong alloc type flags (%08x) !\n", type);
         return STATUS_INVALID_PARAMETER;
     }
 
+    if (type & MEM_LARGE_PAGES)
+    {
+        /* large pages must be reserved and committed at once, on large page boundaries */
+        if ((type & (MEM_COMMIT | MEM_RESERVE)) != (MEM_COMMIT | MEM_RESERVE) ||
+            (type & MEM_WRITE_WATCH)) return STATUS_INVALID_PARAMETER;
+        if ((status = check_lock_memory_privilege())) return status;
+        if (!large_page_size) return STATUS_NOT_SUPPORTED;
+        if (((UINT_PTR)*ret | size) & (large_page_size - 1)) return STATUS_INVALID_PARAMETER;
+        mask |= large_page_size - 1;
+    }
+
     /* Reserve the memory */
 
     if (use_locks) server_enter_uninterrupted_section( &csVirtual, &sigset );
@@ -1901,7 +2020,11 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
     {
         if (type & MEM_WRITE_WATCH) vprot |= VPROT_WRITEWATCH;
         status = map_view( &view, base, size, mask, type & MEM_TOP_DOWN, vprot );
-        if (status == STATUS_SUCCESS) base = view->base;
+        if (status == STATUS_SUCCESS)
+        {
+            base = view->base;
+            if (type & MEM_LARGE_PAGES) set_large_pages( base, size );
+        }
     }
     else if (type & MEM_RESET)
     {
@@ -2412,6 +2535,14 @@ NTSTATUS WINAPI NtCreateSection( HANDLE *handle, ACCESS_MASK access, const OBJEC
 
     if ((ret = get_vprot_flags( protect, &vprot, sec_flags & SEC_IMAGE ))) return ret;
 
+    if (sec_flags & SEC_LARGE_PAGES)
+    {
+        /* only committed anonymous sections can use large pages */
+        if (file || (sec_flags & (SEC_RESERVE | SEC_IMAGE))) return STATUS_INVALID_PARAMETER;
+        if ((ret = check_lock_memory_privilege())) return ret;
+        if (!large_page_size) return STATUS_NOT_SUPPORTED;
+    }
+
     objattr.rootdir = wine_server_obj_handle( attr ? attr->RootDirectory : 0 );
     objattr.sd_len = 0;
     objattr.name_len = len;
@@ -2424,6 +2555,7 @@ NTSTATUS WINAPI NtCreateSection( HANDLE *handle, ACCESS_MASK access, const OBJEC
     if (!(sec_flags & SEC_RESERVE)) vprot |= VPROT_COMMITTED;
     if (sec_flags & SEC_NOCACHE) vprot |= VPROT_NOCACHE;
     if (sec_flags & SEC_IMAGE) vprot |= VPROT_IMAGE;
+    if (sec_flags & SEC_LARGE_PAGES) vprot |= VPROT_LARGE_PAGES;
 
     /* Create the server object */
 
@@ -2489,7 +2621,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
     void *base;
     struct file_view *view;
     DWORD header_size;
-    HANDLE dup_mapping, shared_file;
+    HANDLE dup_mapping, shared_file, image_file;
     LARGE_INTEGER offset;
     sigset_t sigset;
 
@@ -2560,6 +2692,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         header_size = reply->header_size;
         dup_mapping = wine_server_ptr_handle( reply->mapping );
         shared_file = wine_server_ptr_handle( reply->shared_file );
+        image_file  = wine_server_ptr_handle( reply->image_file );
         if ((ULONG_PTR)base != reply->base) base = NULL;
     }
     SERVER_END_REQ;
@@ -2569,6 +2702,8 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
 
     if (map_vprot & VPROT_IMAGE)
     {
+        int shared_fd = -1, shared_needs_close = 0, image_fd = -1, image_needs_close = 0;
+
         size = full_size;
         if (size != full_size)  /* truncated */
         {
@@ -2578,20 +2713,24 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         }
         if (shared_file)
         {
-            int shared_fd, shared_needs_close;
-
-            if ((res = server_get_unix_fd( shared_file, FILE_READ_DATA|FILE_WRITE_DATA,
-                                           &shared_fd, &shared_needs_close, NULL, NULL ))) goto done;
-            res = map_image( handle, unix_handle, base, size, mask, header_size,
-                             shared_fd, dup_mapping, map_vprot, addr_ptr );
-            if (shared_needs_close) close( shared_fd );
+            res = server_get_unix_fd( shared_file, FILE_READ_DATA|FILE_WRITE_DATA,
+                                      &shared_fd, &shared_needs_close, NULL, NULL );
             NtClose( shared_file );
+            shared_file = 0;
+            if (res) goto done;
         }
-        else
+        if (image_file)
         {
-            res = map_image( handle, unix_handle, base, size, mask, header_size,
-                             -1, dup_mapping, map_vprot, addr_ptr );
+            /* not fatal, the sections are read from the file instead */
+            if (server_get_unix_fd( image_file, FILE_READ_DATA, &image_fd, &image_needs_close, NULL, NULL ))
+                image_fd = -1;
+            NtClose( image_file );
+            image_file = 0;
         }
+        res = map_image( handle, unix_handle, base, size, mask, header_size,
+                         shared_fd, image_fd, dup_mapping, map_vprot, addr_ptr );
+        if (shared_needs_close) close( shared_fd );
+        if (image_needs_close) close( image_fd );
         if (needs_close) close( unix_handle );
         if (res >= 0) *size_ptr = size;
         return res;
@@ -2622,6 +2761,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
 
     get_vprot_flags( protect, &vprot, map_vprot & VPROT_IMAGE );
     vprot |= (map_vprot & VPROT_COMMITTED);
+    if (map_vprot & VPROT_LARGE_PAGES) mask |= large_page_size - 1;
     res = map_view( &view, *addr_ptr, size, mask, FALSE, vprot );
     if (res)
     {
@@ -2654,6 +2794,8 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
 
 done:
     if (dup_mapping) NtClose( dup_mapping );
+    if (shared_file) NtClose( shared_file );
+    if (image_file) NtClose( image_file );
     if (needs_close) close( unix_handle );
     return res;
 }
@@ -2818,6 +2960,67 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 }
 
 
+/***********************************************************************
+ *           prefetch_memory
+ *
+ * Start reading in the pages of the specified ranges; this is only a hint,
+ * ranges that are not mapped are silently ignored.
+ */
+static NTSTATUS prefetch_memory( ULONG_PTR count, const MEMORY_RANGE_ENTRY *addresses )
+{
+    sigset_t sigset;
+    ULONG_PTR i;
+
+    for (i = 0; i < count; i++)
+    {
+        SIZE_T size = ROUND_SIZE( addresses[i].VirtualAddress, addresses[i].NumberOfBytes );
+        void *base = ROUND_ADDR( addresses[i].VirtualAddress, page_mask );
+
+        TRACE( "%p-%p\n", base, (char *)base + size );
+
+        if (!size) continue;
+        server_enter_uninterrupted_section( &csVirtual, &sigset );
+#ifdef MADV_WILLNEED
+        if (VIRTUAL_FindView( base, size )) madvise( base, size, MADV_WILLNEED );
+#endif
+        server_leave_uninterrupted_section( &csVirtual, &sigset );
+    }
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *             NtSetInformationVirtualMemory   (NTDLL.@)
+ *             ZwSetInformationVirtualMemory   (NTDLL.@)
+ */
+NTSTATUS WINAPI NtSetInformationVirtualMemory( HANDLE process, VIRTUAL_MEMORY_INFORMATION_CLASS info_class,
+                                               ULONG_PTR count, PMEMORY_RANGE_ENTRY addresses,
+                                               PVOID ptr, ULONG size )
+{
+    TRACE( "%p %d %lu %p %p %u\n", process, info_class, count, addresses, ptr, size );
+
+    switch (info_class)
+    {
+    case VmPrefetchInformation:
+        if (!ptr) return STATUS_INVALID_PARAMETER_5;
+        if (size != sizeof(ULONG)) return STATUS_INVALID_PARAMETER_6;
+        if (!count) return STATUS_INVALID_PARAMETER_3;
+        if (*(ULONG *)ptr) return STATUS_INVALID_PARAMETER_5;
+        if (process != NtCurrentProcess())
+        {
+            FIXME( "prefetch for process %p not supported\n", process );
+            return STATUS_SUCCESS;
+        }
+        return prefetch_memory( count, addresses );
+
+    default:
+        FIXME( "(%p,info_class=%d,%lu,%p,%p,%u) Unknown information class\n",
+               process, info_class, count, addresses, ptr, size );
+        return STATUS_INVALID_PARAMETER_2;
+    }
+}
+
+
 /***********************************************************************
  *             NtReadVirtualMemory   (NTDLL.@)
  *             ZwReadVirtualMemory   (NTDLL.@)
@@ -83,6 +83,210 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* Conversions that need a temporary copy of the source read it a band of rows
+ * at a time, so memory use doesn't depend on the size of the rectangle and
+ * the rows are still in the cache when they are converted. */
+#define CONVERT_BAND_SIZE 0x10000
+
+typedef void (*convert_rows_func)(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height);
+
+static HRESULT copypixels_raw(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
+{
+    return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+}
+
+static HRESULT copypixels_by_band(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, BYTE *pbBuffer, copyfunc read, UINT read_bpp, enum pixelformat source_format,
+    convert_rows_func convert)
+{
+    HRESULT res = S_OK;
+    BYTE *srcdata;
+    UINT srcstride, band_height;
+    WICRect band;
+    INT y;
+
+    srcstride = (read_bpp * prc->Width + 7) / 8;
+    if (!srcstride || prc->Height <= 0) return S_OK;
+
+    band_height = max(CONVERT_BAND_SIZE / srcstride, 1);
+    band_height = min(band_height, prc->Height);
+
+    srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * band_height);
+    if (!srcdata) return E_OUTOFMEMORY;
+
+    band.X = prc->X;
+    band.Width = prc->Width;
+
+    for (y=0; y<prc->Height && SUCCEEDED(res); y+=band.Height)
+    {
+        band.Y = prc->Y + y;
+        band.Height = min(band_height, prc->Height - y);
+
+        res = read(This, &band, srcstride, srcstride * band.Height, srcdata, source_format);
+        if (SUCCEEDED(res))
+            convert(srcdata, srcstride, pbBuffer + cbStride * y, cbStride, prc->Width, band.Height);
+    }
+
+    HeapFree(GetProcessHeap(), 0, srcdata);
+
+    return res;
+}
+
+static void convert_8bppGray_to_32bppBGRA(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        DWORD *dstpixel = (DWORD*)dst;
+        for (x=0; x<width; x++)
+            dstpixel[x] = 0xff000000|(src[x]<<16)|(src[x]<<8)|src[x];
+    }
+}
+
+static void convert_24bppBGR_to_32bppBGRA(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        DWORD *dstpixel = (DWORD*)dst;
+        for (x=0; x<width; x++, srcpixel+=3)
+            dstpixel[x] = 0xff000000|(srcpixel[2]<<16)|(srcpixel[1]<<8)|srcpixel[0];
+    }
+}
+
+static void convert_24bppRGB_to_32bppBGRA(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        DWORD *dstpixel = (DWORD*)dst;
+        for (x=0; x<width; x++, srcpixel+=3)
+            dstpixel[x] = 0xff000000|(srcpixel[0]<<16)|(srcpixel[1]<<8)|srcpixel[2];
+    }
+}
+
+static void convert_48bppRGB_to_32bppBGRA(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        DWORD *dstpixel = (DWORD*)dst;
+        for (x=0; x<width; x++, srcpixel+=6)
+            dstpixel[x] = 0xff000000|(srcpixel[0]<<16)|(srcpixel[2]<<8)|srcpixel[4];
+    }
+}
+
+static void convert_64bppRGBA_to_32bppBGRA(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        DWORD *dstpixel = (DWORD*)dst;
+        for (x=0; x<width; x++, srcpixel+=8)
+            dstpixel[x] = (srcpixel[6]<<24)|(srcpixel[0]<<16)|(srcpixel[2]<<8)|srcpixel[4];
+    }
+}
+
+static void convert_32bpp_to_24bppBGR(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        BYTE *dstpixel = dst;
+        for (x=0; x<width; x++, srcpixel+=4, dstpixel+=3)
+        {
+            dstpixel[0] = srcpixel[0]; /* blue */
+            dstpixel[1] = srcpixel[1]; /* green */
+            dstpixel[2] = srcpixel[2]; /* red */
+        }
+    }
+}
+
+static void convert_32bpp_to_24bppRGB(const BYTE *src, UINT srcstride, BYTE *dst, UINT dststride,
+    UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, src+=srcstride, dst+=dststride)
+    {
+        const BYTE *srcpixel = src;
+        BYTE *dstpixel = dst;
+        for (x=0; x<width; x++, srcpixel+=4, dstpixel+=3)
+        {
+            dstpixel[0] = srcpixel[2]; /* red */
+            dstpixel[1] = srcpixel[1]; /* green */
+            dstpixel[2] = srcpixel[0]; /* blue */
+        }
+    }
+}
+
+/* exact value of x / 255 for x <= 255 * 255, without a division */
+static inline BYTE div255(UINT x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static void premultiply_32bppBGRA(BYTE *bits, UINT stride, UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, bits+=stride)
+    {
+        BYTE *pixel = bits;
+        for (x=0; x<width; x++, pixel+=4)
+        {
+            BYTE alpha = pixel[3];
+            if (alpha != 255)
+            {
+                pixel[0] = div255(pixel[0] * alpha);
+                pixel[1] = div255(pixel[1] * alpha);
+                pixel[2] = div255(pixel[2] * alpha);
+            }
+        }
+    }
+}
+
+static void unpremultiply_32bppBGRA(BYTE *bits, UINT stride, UINT width, UINT height)
+{
+    UINT x, y;
+
+    for (y=0; y<height; y++, bits+=stride)
+    {
+        BYTE *pixel = bits;
+        for (x=0; x<width; x++, pixel+=4)
+        {
+            BYTE alpha = pixel[3];
+            if (alpha != 0 && alpha != 255)
+            {
+                /* one division per pixel, gives the same result as c * 255 / alpha */
+                UINT scale = ((255 << 16) + alpha - 1) / alpha;
+                pixel[0] = (pixel[0] * scale) >> 16;
+                pixel[1] = (pixel[1] * scale) >> 16;
+                pixel[2] = (pixel[2] * scale) >> 16;
+            }
+        }
+    }
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -281,45 +485,8 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         return S_OK;
     case format_8bppGray:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++)
-                    {
-                        *dstpixel++ = 0xff000000|(*srcbyte<<16)|(*srcbyte<<8)|*srcbyte;
-                        srcbyte++;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 8,
+                source_format, convert_8bppGray_to_32bppBGRA);
         return S_OK;
     case format_8bppIndexed:
         if (prc)
@@ -562,94 +729,13 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         return S_OK;
     case format_24bppBGR:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 24,
+                source_format, convert_24bppBGR_to_32bppBGRA);
         return S_OK;
     case format_24bppRGB:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 24,
+                source_format, convert_24bppRGB_to_32bppBGRA);
         return S_OK;
     case format_32bppBGR:
         if (prc)
@@ -674,112 +760,22 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_32bppBGRA(pbBuffer, cbStride, prc->Width, prc->Height);
         }
         return S_OK;
     case format_48bppRGB:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 6 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        *dstpixel++=0xff000000|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 48,
+                source_format, convert_48bppRGB_to_32bppBGRA);
         return S_OK;
     case format_64bppRGBA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 8 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        alpha = *srcpixel++; srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 64,
+                source_format, convert_64bppRGBA_to_32bppBGRA);
         return S_OK;
     case format_32bppCMYK:
         if (prc)
@@ -834,24 +830,24 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
         if (prc)
             return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
+    case format_BlackWhite:
+    case format_2bppGray:
+    case format_4bppGray:
+    case format_8bppGray:
+    case format_16bppGray:
+    case format_16bppBGR555:
+    case format_16bppBGR565:
+    case format_24bppBGR:
+    case format_24bppRGB:
+    case format_32bppBGR:
+    case format_48bppRGB:
+    case format_32bppCMYK:
+        /* opaque, so there is nothing to premultiply */
+        return copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_32bppBGRA(pbBuffer, cbStride, prc->Width, prc->Height);
         return hr;
     }
 }
@@ -877,50 +873,15 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 32,
+                source_format, convert_32bpp_to_24bppBGR);
         return S_OK;
     default:
-        FIXME("Unimplemented conversion path!\n");
-        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+        /* go through 32bppBGRA a band at a time */
+        if (prc)
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_to_32bppBGRA, 32,
+                source_format, convert_32bpp_to_24bppBGR);
+        return copypixels_to_32bppBGRA(This, NULL, cbStride, cbBufferSize, pbBuffer, source_format);
     }
 }
 
@@ -945,52 +906,15 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-
-                reverse_bgr8(3, pbBuffer, prc->Width, prc->Height, cbStride);
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_raw, 32,
+                source_format, convert_32bpp_to_24bppRGB);
         return S_OK;
     default:
-        FIXME("Unimplemented conversion path!\n");
-        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+        /* go through 32bppBGRA a band at a time */
+        if (prc)
+            return copypixels_by_band(This, prc, cbStride, pbBuffer, copypixels_to_32bppBGRA, 32,
+                source_format, convert_32bpp_to_24bppRGB);
+        return copypixels_to_32bppBGRA(This, NULL, cbStride, cbBufferSize, pbBuffer, source_format);
     }
 }
 
@@ -169,6 +169,7 @@ MAKE_FUNCPTR(png_get_error_ptr);
 MAKE_FUNCPTR(png_get_iCCP);
 MAKE_FUNCPTR(png_get_image_height);
 MAKE_FUNCPTR(png_get_image_width);
+MAKE_FUNCPTR(png_get_interlace_type);
 MAKE_FUNCPTR(png_get_io_ptr);
 MAKE_FUNCPTR(png_get_pHYs);
 MAKE_FUNCPTR(png_get_PLTE);
@@ -192,6 +193,7 @@ MAKE_FUNCPTR(png_set_write_fn);
 MAKE_FUNCPTR(png_read_end);
 MAKE_FUNCPTR(png_read_image);
 MAKE_FUNCPTR(png_read_info);
+MAKE_FUNCPTR(png_read_row);
 MAKE_FUNCPTR(png_write_end);
 MAKE_FUNCPTR(png_write_info);
 MAKE_FUNCPTR(png_write_rows);
@@ -218,6 +220,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_get_iCCP);
         LOAD_FUNCPTR(png_get_image_height);
         LOAD_FUNCPTR(png_get_image_width);
+        LOAD_FUNCPTR(png_get_interlace_type);
         LOAD_FUNCPTR(png_get_io_ptr);
         LOAD_FUNCPTR(png_get_pHYs);
         LOAD_FUNCPTR(png_get_PLTE);
@@ -241,6 +244,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_read_end);
         LOAD_FUNCPTR(png_read_image);
         LOAD_FUNCPTR(png_read_info);
+        LOAD_FUNCPTR(png_read_row);
         LOAD_FUNCPTR(png_write_end);
         LOAD_FUNCPTR(png_write_info);
         LOAD_FUNCPTR(png_write_rows);
@@ -281,6 +285,11 @@ typedef struct {
     UINT stride;
     const WICPixelFormatGUID *format;
     BYTE *image_bits;
+    IStream *stream;
+    ULARGE_INTEGER stream_pos; /* where libpng continues reading image data */
+    BOOL interlaced;
+    UINT rows_read;
+    BOOL read_failed; /* png_ptr can't be used for decoding after libpng reported an error */
     CRITICAL_SECTION lock; /* must be held when png structures are accessed or initialized is set */
 } PngDecoder;
 
@@ -346,6 +355,7 @@ static ULONG WINAPI PngDecoder_Release(IWICBitmapDecoder *iface)
             ppng_destroy_read_struct(&This->png_ptr, &This->info_ptr, &This->end_info);
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
+        if (This->stream) IStream_Release(This->stream);
         HeapFree(GetProcessHeap(), 0, This->image_bits);
         HeapFree(GetProcessHeap(), 0, This);
     }
@@ -390,9 +400,6 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     PngDecoder *This = impl_from_IWICBitmapDecoder(iface);
     LARGE_INTEGER seek;
     HRESULT hr=S_OK;
-    png_bytep *row_pointers=NULL;
-    UINT image_size;
-    UINT i;
     int color_type, bit_depth;
     png_bytep trans;
     int num_trans;
@@ -434,7 +441,6 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     if (setjmp(jmpbuf))
     {
         ppng_destroy_read_struct(&This->png_ptr, &This->info_ptr, &This->end_info);
-        HeapFree(GetProcessHeap(), 0, row_pointers);
         This->png_ptr = NULL;
         hr = E_FAIL;
         goto end;
@@ -551,35 +557,20 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
         goto end;
     }
 
-    /* read the image data */
     This->width = ppng_get_image_width(This->png_ptr, This->info_ptr);
     This->height = ppng_get_image_height(This->png_ptr, This->info_ptr);
-    This->stride = This->width * This->bpp;
-    image_size = This->stride * This->height;
-
-    This->image_bits = HeapAlloc(GetProcessHeap(), 0, image_size);
-    if (!This->image_bits)
-    {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
-
-    row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
-    if (!row_pointers)
-    {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
-
-    for (i=0; i<This->height; i++)
-        row_pointers[i] = This->image_bits + i * This->stride;
+    This->stride = (This->width * This->bpp + 7) / 8;
+    This->interlaced = ppng_get_interlace_type(This->png_ptr, This->info_ptr) != PNG_INTERLACE_NONE;
 
-    ppng_read_image(This->png_ptr, row_pointers);
-
-    HeapFree(GetProcessHeap(), 0, row_pointers);
-    row_pointers = NULL;
+    /* the image data is read when it's first needed, see PngDecoder_ReadRows */
+    seek.QuadPart = 0;
+    hr = IStream_Seek(pIStream, seek, STREAM_SEEK_CUR, &This->stream_pos);
+    if (FAILED(hr)) goto end;
 
-    ppng_read_end(This->png_ptr, This->end_info);
+    IStream_AddRef(pIStream);
+    This->stream = pIStream;
+    This->rows_read = 0;
+    This->read_failed = FALSE;
 
     This->initialized = TRUE;
 
@@ -844,12 +835,97 @@ end:
     return hr;
 }
 
+/* Decodes rows up to rows_needed into image_bits. Non-interlaced images are
+ * decoded a row at a time, so only the part of the image that has been asked
+ * for is ever read from the stream. Must be called with the lock held. */
+static HRESULT PngDecoder_ReadRows(PngDecoder *This, UINT rows_needed)
+{
+    png_bytep *row_pointers = NULL;
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    HRESULT hr;
+    UINT i;
+
+    if (This->read_failed) return E_FAIL;
+    if (rows_needed <= This->rows_read) return S_OK;
+
+    if (!This->image_bits)
+    {
+        This->image_bits = HeapAlloc(GetProcessHeap(), 0, This->stride * This->height);
+        if (!This->image_bits) return E_OUTOFMEMORY;
+    }
+
+    if (This->interlaced)
+    {
+        /* every pass touches the whole image, so read it all at once */
+        row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
+        if (!row_pointers) return E_OUTOFMEMORY;
+
+        for (i=0; i<This->height; i++)
+            row_pointers[i] = This->image_bits + i * This->stride;
+    }
+
+    /* the stream may have been used by someone else since the last read */
+    seek.QuadPart = This->stream_pos.QuadPart;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    if (FAILED(hr))
+    {
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        return hr;
+    }
+
+    if (setjmp(jmpbuf))
+    {
+        /* libpng's state is undefined after an error, so don't try again */
+        This->read_failed = TRUE;
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        return E_FAIL;
+    }
+    ppng_set_error_fn(This->png_ptr, jmpbuf, user_error_fn, user_warning_fn);
+
+    if (row_pointers)
+    {
+        ppng_read_image(This->png_ptr, row_pointers);
+        This->rows_read = This->height;
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+    }
+    else
+    {
+        while (This->rows_read < rows_needed)
+        {
+            ppng_read_row(This->png_ptr, This->image_bits + This->rows_read * This->stride, NULL);
+            This->rows_read++;
+        }
+    }
+
+    if (This->rows_read == This->height)
+        ppng_read_end(This->png_ptr, This->end_info);
+
+    seek.QuadPart = 0;
+    return IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &This->stream_pos);
+}
+
 static HRESULT WINAPI PngDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     PngDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    UINT rows_needed = This->height;
+    HRESULT hr;
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
+    if (prc)
+    {
+        if (prc->X < 0 || prc->Y < 0 || prc->Width < 0 || prc->Height < 0 ||
+            prc->X+prc->Width > This->width || prc->Y+prc->Height > This->height)
+            return E_INVALIDARG;
+        rows_needed = prc->Y + prc->Height;
+    }
+
+    EnterCriticalSection(&This->lock);
+    hr = PngDecoder_ReadRows(This, rows_needed);
+    LeaveCriticalSection(&This->lock);
+    if (FAILED(hr)) return hr;
+
     return copy_pixels(This->bpp, This->image_bits,
         This->width, This->height, This->stride,
         prc, cbStride, cbBufferSize, pbBuffer);
@@ -1011,6 +1087,10 @@ HRESULT PngDecoder_CreateInstance(REFIID iid, void** ppv)
     This->end_info = NULL;
     This->initialized = FALSE;
     This->image_bits = NULL;
+    This->stream = NULL;
+    This->interlaced = FALSE;
+    This->rows_read = 0;
+    This->read_failed = FALSE;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": PngDecoder.lock");
 
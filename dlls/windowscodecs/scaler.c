@@ -19,6 +19,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -43,9 +44,162 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    /* separable filters, used for every mode but NearestNeighbor */
+    struct scaler_filter *filter_x, *filter_y;
+    UINT channels;
+    BOOL premultiplied;
+    BYTE *src_row;
+    INT *row_cache; /* horizontally filtered source rows, filter_y->max_taps of them */
+    UINT *row_cache_y;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
+#define FILTER_SHIFT 14
+#define FILTER_ROW_SHIFT 7
+
+/* Precomputed weights for one direction: destination pixel i is the sum of
+ * source pixels start[i]..start[i]+count[i]-1, weighted by
+ * weights[i*max_taps]..., in FILTER_SHIFT fixed point. */
+struct scaler_filter {
+    UINT max_taps;
+    UINT *start;
+    UINT *count;
+    INT *weights;
+};
+
+static void free_scaler_filter(struct scaler_filter *filter)
+{
+    if (!filter) return;
+    HeapFree(GetProcessHeap(), 0, filter->start);
+    HeapFree(GetProcessHeap(), 0, filter->count);
+    HeapFree(GetProcessHeap(), 0, filter->weights);
+    HeapFree(GetProcessHeap(), 0, filter);
+}
+
+static double filter_linear(double t)
+{
+    t = fabs(t);
+    return t < 1.0 ? 1.0 - t : 0.0;
+}
+
+static double filter_cubic(double t)
+{
+    /* Catmull-Rom spline */
+    t = fabs(t);
+    if (t < 1.0) return (1.5 * t - 2.5) * t * t + 1.0;
+    if (t < 2.0) return ((-0.5 * t + 2.5) * t - 4.0) * t + 2.0;
+    return 0.0;
+}
+
+static struct scaler_filter *create_scaler_filter(WICBitmapInterpolationMode mode,
+    UINT src_size, UINT dst_size)
+{
+    struct scaler_filter *filter;
+    double scale = (double)src_size / dst_size, fscale, support;
+    double (*fn)(double) = NULL;
+    double *taps;
+    UINT i;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        fn = filter_linear;
+        support = 1.0;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        fn = filter_cubic;
+        support = 2.0;
+        break;
+    default: /* Fant, area averaging */
+        support = 0.5;
+        break;
+    }
+
+    fscale = max(scale, 1.0);
+    support *= fscale;
+
+    filter = HeapAlloc(GetProcessHeap(), 0, sizeof(*filter));
+    if (!filter) return NULL;
+
+    filter->max_taps = (UINT)ceil(support * 2.0) + 1;
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(UINT));
+    filter->count = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(UINT));
+    filter->weights = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY,
+        dst_size * filter->max_taps * sizeof(INT));
+    taps = HeapAlloc(GetProcessHeap(), 0, filter->max_taps * sizeof(double));
+
+    if (!filter->start || !filter->count || !filter->weights || !taps)
+    {
+        HeapFree(GetProcessHeap(), 0, taps);
+        free_scaler_filter(filter);
+        return NULL;
+    }
+
+    for (i=0; i<dst_size; i++)
+    {
+        double center = (i + 0.5) * scale, total = 0.0;
+        INT left, right, j, sum, largest = 0;
+        INT *weights = filter->weights + i * filter->max_taps;
+
+        left = (INT)floor(center - support);
+        right = (INT)ceil(center + support);
+        if (left < 0) left = 0;
+        if (right > src_size) right = src_size;
+        if (right - left > filter->max_taps) right = left + filter->max_taps;
+
+        for (j=left; j<right; j++)
+        {
+            double w;
+
+            if (fn)
+                w = fn((j + 0.5 - center) / fscale);
+            else
+            {
+                /* overlap of the source pixel with the destination pixel */
+                double lo = max(center - support, (double)j);
+                double hi = min(center + support, (double)(j + 1));
+                w = hi > lo ? hi - lo : 0.0;
+            }
+
+            taps[j - left] = w;
+            total += w;
+        }
+
+        /* skip zero weights at either end */
+        while (left < right - 1 && taps[0] == 0.0)
+        {
+            memmove(taps, taps + 1, (right - left - 1) * sizeof(double));
+            left++;
+        }
+        while (right > left + 1 && taps[right - left - 1] == 0.0)
+            right--;
+
+        if (total == 0.0)
+        {
+            /* can only happen when the window is empty, use the nearest pixel */
+            left = min((UINT)center, src_size - 1);
+            right = left + 1;
+            taps[0] = total = 1.0;
+        }
+
+        for (j=0, sum=0; j<right-left; j++)
+        {
+            weights[j] = (INT)floor(taps[j] / total * (1 << FILTER_SHIFT) + 0.5);
+            sum += weights[j];
+            if (weights[j] > weights[largest]) largest = j;
+        }
+        /* make the weights add up exactly so flat areas stay flat */
+        weights[largest] += (1 << FILTER_SHIFT) - sum;
+
+        filter->start[i] = left;
+        filter->count[i] = right - left;
+    }
+
+    HeapFree(GetProcessHeap(), 0, taps);
+
+    return filter;
+}
+
 static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
 {
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
@@ -97,6 +251,11 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_scaler_filter(This->filter_x);
+        free_scaler_filter(This->filter_y);
+        HeapFree(GetProcessHeap(), 0, This->src_row);
+        HeapFree(GetProcessHeap(), 0, This->row_cache);
+        HeapFree(GetProcessHeap(), 0, This->row_cache_y);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -191,6 +350,112 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Returns a source row filtered horizontally to the full destination width,
+ * reading it from the source if it isn't cached already. */
+static HRESULT Filter_GetRow(BitmapScaler *This, UINT src_y, INT **row)
+{
+    const struct scaler_filter *fx = This->filter_x;
+    UINT slot = src_y % This->filter_y->max_taps;
+    UINT channels = This->channels;
+    INT *dst = This->row_cache + slot * This->width * channels;
+    WICRect rc;
+    HRESULT hr;
+    UINT x, i, c;
+
+    *row = dst;
+
+    if (This->row_cache_y[slot] == src_y)
+        return S_OK;
+
+    rc.X = 0;
+    rc.Y = src_y;
+    rc.Width = This->src_width;
+    rc.Height = 1;
+
+    hr = IWICBitmapSource_CopyPixels(This->source, &rc, This->src_width * channels,
+        This->src_width * channels, This->src_row);
+    if (FAILED(hr))
+    {
+        This->row_cache_y[slot] = ~0u;
+        return hr;
+    }
+
+    for (x=0; x<This->width; x++)
+    {
+        const BYTE *src = This->src_row + fx->start[x] * channels;
+        const INT *weights = fx->weights + x * fx->max_taps;
+        INT sum[4] = {0, 0, 0, 0};
+
+        for (i=0; i<fx->count[x]; i++, src += channels)
+            for (c=0; c<channels; c++)
+                sum[c] += src[c] * weights[i];
+
+        for (c=0; c<channels; c++)
+            *dst++ = (sum[c] + (1 << (FILTER_SHIFT - FILTER_ROW_SHIFT - 1))) >> (FILTER_SHIFT - FILTER_ROW_SHIFT);
+    }
+
+    This->row_cache_y[slot] = src_y;
+
+    return S_OK;
+}
+
+/* Filtered modes read the source one row at a time and keep just enough
+ * horizontally filtered rows around for the vertical filter, so memory use
+ * doesn't grow with the image size. The rows stay cached between calls, which
+ * makes the recommended scanline-by-scanline top to bottom access cheap. */
+static HRESULT Filter_CopyPixels(BitmapScaler *This, const WICRect *dest_rect,
+    UINT cbStride, BYTE *pbBuffer)
+{
+    const struct scaler_filter *fy = This->filter_y;
+    UINT channels = This->channels;
+    INT *rows[256], **src_rows = rows;
+    HRESULT hr = S_OK;
+    UINT x, y, i;
+
+    if (fy->max_taps > sizeof(rows)/sizeof(rows[0]))
+    {
+        src_rows = HeapAlloc(GetProcessHeap(), 0, fy->max_taps * sizeof(INT*));
+        if (!src_rows) return E_OUTOFMEMORY;
+    }
+
+    for (y=dest_rect->Y; y<dest_rect->Y+dest_rect->Height; y++)
+    {
+        const INT *weights = fy->weights + y * fy->max_taps;
+        BYTE *dst = pbBuffer + cbStride * (y - dest_rect->Y);
+
+        for (i=0; i<fy->count[y] && SUCCEEDED(hr); i++)
+            hr = Filter_GetRow(This, fy->start[y] + i, &src_rows[i]);
+        if (FAILED(hr)) break;
+
+        for (x=dest_rect->X * channels; x<(dest_rect->X+dest_rect->Width) * channels; x++)
+        {
+            INT sum = 0;
+
+            for (i=0; i<fy->count[y]; i++)
+                sum += src_rows[i][x] * weights[i];
+
+            sum = (sum + (1 << (FILTER_SHIFT + FILTER_ROW_SHIFT - 1))) >> (FILTER_SHIFT + FILTER_ROW_SHIFT);
+            *dst++ = sum < 0 ? 0 : (sum > 0xff ? 0xff : sum);
+        }
+
+        /* negative filter lobes can push a color above its alpha, which isn't
+         * valid premultiplied data */
+        if (This->premultiplied)
+        {
+            for (dst = pbBuffer + cbStride * (y - dest_rect->Y), x = 0; x < dest_rect->Width; x++, dst += 4)
+            {
+                if (dst[0] > dst[3]) dst[0] = dst[3];
+                if (dst[1] > dst[3]) dst[1] = dst[3];
+                if (dst[2] > dst[3]) dst[2] = dst[3];
+            }
+        }
+    }
+
+    if (src_rows != rows) HeapFree(GetProcessHeap(), 0, src_rows);
+
+    return hr;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -245,6 +510,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->filter_x)
+    {
+        hr = Filter_CopyPixels(This, &dest_rect, cbStride, pbBuffer);
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -300,6 +571,63 @@ end:
     return hr;
 }
 
+/* formats made of 8-bit channels can be filtered as they are, the others keep
+ * their format and are scaled with NearestNeighbor */
+static BOOL Filter_IsFormatSupported(const WICPixelFormatGUID *format)
+{
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppRGB) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA);
+}
+
+static HRESULT Filter_Initialize(BitmapScaler *This, IWICBitmapSource *source,
+    const WICPixelFormatGUID *format)
+{
+    UINT i;
+
+    if (!This->width || !This->height || !This->src_width || !This->src_height)
+        return E_INVALIDARG;
+
+    IWICBitmapSource_AddRef(source);
+    This->source = source;
+    This->channels = This->bpp / 8;
+    This->premultiplied = IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA);
+
+    This->filter_x = create_scaler_filter(This->mode, This->src_width, This->width);
+    This->filter_y = create_scaler_filter(This->mode, This->src_height, This->height);
+    if (This->filter_x && This->filter_y)
+    {
+        This->src_row = HeapAlloc(GetProcessHeap(), 0, This->src_width * This->channels);
+        This->row_cache = HeapAlloc(GetProcessHeap(), 0,
+            This->filter_y->max_taps * This->width * This->channels * sizeof(INT));
+        This->row_cache_y = HeapAlloc(GetProcessHeap(), 0, This->filter_y->max_taps * sizeof(UINT));
+    }
+
+    if (!This->src_row || !This->row_cache || !This->row_cache_y)
+    {
+        free_scaler_filter(This->filter_x);
+        free_scaler_filter(This->filter_y);
+        HeapFree(GetProcessHeap(), 0, This->src_row);
+        HeapFree(GetProcessHeap(), 0, This->row_cache);
+        HeapFree(GetProcessHeap(), 0, This->row_cache_y);
+        This->filter_x = This->filter_y = NULL;
+        This->src_row = NULL;
+        This->row_cache = NULL;
+        This->row_cache_y = NULL;
+        IWICBitmapSource_Release(This->source);
+        This->source = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    for (i=0; i<This->filter_y->max_taps; i++)
+        This->row_cache_y[i] = ~0u;
+
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     IWICBitmapSource *pISource, UINT uiWidth, UINT uiHeight,
     WICBitmapInterpolationMode mode)
@@ -332,10 +660,22 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         hr = get_pixelformat_bpp(&src_pixelformat, &This->bpp);
     }
 
+    if (SUCCEEDED(hr) && mode != WICBitmapInterpolationModeNearestNeighbor &&
+        mode <= WICBitmapInterpolationModeFant && !Filter_IsFormatSupported(&src_pixelformat))
+    {
+        TRACE("can't filter %s, using NearestNeighbor\n", debugstr_guid(&src_pixelformat));
+        This->mode = mode = WICBitmapInterpolationModeNearestNeighbor;
+    }
+
     if (SUCCEEDED(hr))
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            hr = Filter_Initialize(This, pISource, &src_pixelformat);
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
@@ -391,6 +731,13 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    This->filter_x = NULL;
+    This->filter_y = NULL;
+    This->channels = 0;
+    This->premultiplied = FALSE;
+    This->src_row = NULL;
+    This->row_cache = NULL;
+    This->row_cache_y = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -977,6 +977,171 @@ static void test_clipper(void)
     IWICBitmapClipper_Release(clipper);
 }
 
+static IWICBitmapScaler *create_scaler(IWICBitmap *bitmap, UINT width, UINT height,
+    WICBitmapInterpolationMode mode)
+{
+    IWICBitmapScaler *scaler;
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, width, height, mode);
+    ok(hr == S_OK, "mode %u: Initialize error %#x\n", mode, hr);
+
+    return scaler;
+}
+
+static void test_bitmap_scaler(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+    };
+    static const BYTE data2x2[12] = {
+        0,0,0,       100,100,100,
+        20,40,60,    200,220,240 };
+    static const BYTE edge4x1[16] = {
+        0,0,0,128,   0,0,0,128,   128,128,128,128,   128,128,128,128 };
+    BYTE src[7 * 5 * 3], full[4 * 3 * 3], row[4 * 3], wide[16 * 4];
+    WORD src16[4 * 4], full16[2 * 2];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j, y, width, height;
+    GUID format;
+    HRESULT hr;
+
+    /* a flat colour stays flat, whatever the filter */
+    for (i = 0; i < 7 * 5; i++)
+    {
+        src[i * 3] = 10;
+        src[i * 3 + 1] = 120;
+        src[i * 3 + 2] = 250;
+    }
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 7, 5, &GUID_WICPixelFormat24bppBGR,
+                                                   7 * 3, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        scaler = create_scaler(bitmap, 4, 3, modes[i]);
+
+        hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+        ok(hr == S_OK, "mode %u: GetSize error %#x\n", modes[i], hr);
+        ok(width == 4 && height == 3, "mode %u: got %ux%u\n", modes[i], width, height);
+
+        memset(full, 0xcc, sizeof(full));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 4 * 3, sizeof(full), full);
+        ok(hr == S_OK, "mode %u: CopyPixels error %#x\n", modes[i], hr);
+        for (j = 0; j < 4 * 3; j++)
+            ok(full[j * 3] == 10 && full[j * 3 + 1] == 120 && full[j * 3 + 2] == 250,
+               "mode %u: %u: got %u,%u,%u\n", modes[i], j, full[j * 3], full[j * 3 + 1], full[j * 3 + 2]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* Fant averages the source pixels covered by the destination pixel */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 2, 2, &GUID_WICPixelFormat24bppBGR,
+                                                   2 * 3, sizeof(data2x2), (BYTE *)data2x2, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    scaler = create_scaler(bitmap, 1, 1, WICBitmapInterpolationModeFant);
+    memset(full, 0xcc, sizeof(full));
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 3, 3, full);
+    ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+    ok(full[0] == 80 && full[1] == 90 && full[2] == 100,
+       "got %u,%u,%u\n", full[0], full[1], full[2]);
+    IWICBitmapScaler_Release(scaler);
+
+    IWICBitmap_Release(bitmap);
+
+    /* copying one row at a time gives the same result as copying everything at once */
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = (i * 37) % 251;
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 7, 5, &GUID_WICPixelFormat24bppBGR,
+                                                   7 * 3, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        scaler = create_scaler(bitmap, 4, 3, modes[i]);
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 4 * 3, sizeof(full), full);
+        ok(hr == S_OK, "mode %u: CopyPixels error %#x\n", modes[i], hr);
+        IWICBitmapScaler_Release(scaler);
+
+        scaler = create_scaler(bitmap, 4, 3, modes[i]);
+        for (y = 0; y < 3; y++)
+        {
+            WICRect rc = {0, y, 4, 1};
+
+            memset(row, 0xcc, sizeof(row));
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizeof(row), sizeof(row), row);
+            ok(hr == S_OK, "mode %u: row %u: CopyPixels error %#x\n", modes[i], y, hr);
+            ok(!memcmp(row, full + y * sizeof(row), sizeof(row)),
+               "mode %u: row %u doesn't match\n", modes[i], y);
+        }
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* formats that aren't made of 8-bit channels keep their format */
+    for (i = 0; i < 4 * 4; i++)
+        src16[i] = 0x1234 + i;
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 4, &GUID_WICPixelFormat16bppBGR555,
+                                                   4 * 2, sizeof(src16), (BYTE *)src16, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        scaler = create_scaler(bitmap, 2, 2, modes[i]);
+
+        hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+        ok(hr == S_OK, "mode %u: GetPixelFormat error %#x\n", modes[i], hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat16bppBGR555),
+           "mode %u: got wrong format %s\n", modes[i], wine_dbgstr_guid(&format));
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2 * 2, sizeof(full16), (BYTE *)full16);
+        ok(hr == S_OK, "mode %u: CopyPixels error %#x\n", modes[i], hr);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* premultiplied colors never end up larger than their alpha */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 1, &GUID_WICPixelFormat32bppPBGRA,
+                                                   4 * 4, sizeof(edge4x1), (BYTE *)edge4x1, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        scaler = create_scaler(bitmap, 16, 1, modes[i]);
+
+        hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+        ok(hr == S_OK, "mode %u: GetPixelFormat error %#x\n", modes[i], hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat32bppPBGRA),
+           "mode %u: got wrong format %s\n", modes[i], wine_dbgstr_guid(&format));
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 16 * 4, sizeof(wide), wide);
+        ok(hr == S_OK, "mode %u: CopyPixels error %#x\n", modes[i], hr);
+        for (j = 0; j < 16; j++)
+            ok(wide[j * 4] <= wide[j * 4 + 3] && wide[j * 4 + 1] <= wide[j * 4 + 3] &&
+               wide[j * 4 + 2] <= wide[j * 4 + 3], "mode %u: %u: got %u,%u,%u,%u\n", modes[i], j,
+               wide[j * 4], wide[j * 4 + 1], wide[j * 4 + 2], wide[j * 4 + 3]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -993,6 +1158,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHICON();
     test_CreateBitmapFromHBITMAP();
     test_clipper();
+    test_bitmap_scaler();
 
     IWICImagingFactory_Release(factory);
 
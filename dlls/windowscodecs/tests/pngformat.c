@@ -573,6 +573,78 @@ static void test_png_palette(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+/* 8 bpp 4x4 grayscale PNG image, pixel (x, y) is y * 16 + x, stored uncompressed */
+static const char png_gray_4x4[] = {
+  0x89,'P','N','G',0x0d,0x0a,0x1a,0x0a,
+  0x00,0x00,0x00,0x0d,'I','H','D','R',0x00,0x00,0x00,0x04,0x00,0x00,0x00,0x04,0x08,0x00,0x00,0x00,0x00,0x8c,0x9a,0xc1,0xa2,
+  0x00,0x00,0x00,0x1f,'I','D','A','T',0x78,0x01,0x01,0x14,0x00,0xeb,0xff,
+  0x00,0x00,0x01,0x02,0x03,0x00,0x10,0x11,0x12,0x13,0x00,0x20,0x21,0x22,0x23,0x00,0x30,0x31,0x32,0x33,
+  0x09,0xb0,0x01,0x99,0xf3,0x86,0xa2,0xf5,
+  0x00,0x00,0x00,0x00,'I','E','N','D',0xae,0x42,0x60,0x82
+};
+
+static void test_png_copy_pixels(void)
+{
+    static const WICRect rects[] =
+    {
+        {0, 1, 4, 1},
+        {1, 2, 2, 2},
+        {0, 0, 4, 1},
+        {3, 0, 1, 4},
+        {0, 0, 4, 4},
+    };
+    IWICBitmapFrameDecode *frame;
+    IWICBitmapDecoder *decoder;
+    BYTE buf[16];
+    unsigned int i, x, y;
+    GUID format;
+    HRESULT hr;
+
+    decoder = create_decoder(png_gray_4x4, sizeof(png_gray_4x4));
+    ok(decoder != 0, "Failed to load PNG image data\n");
+
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame error %#x\n", hr);
+
+    hr = IWICBitmapFrameDecode_GetPixelFormat(frame, &format);
+    ok(hr == S_OK, "GetPixelFormat error %#x\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat8bppGray),
+       "got wrong format %s\n", wine_dbgstr_guid(&format));
+
+    /* rows are requested out of order, before and after they have been decoded */
+    for (i = 0; i < sizeof(rects) / sizeof(rects[0]); i++)
+    {
+        const WICRect *rc = &rects[i];
+
+        memset(buf, 0xcc, sizeof(buf));
+        hr = IWICBitmapFrameDecode_CopyPixels(frame, rc, rc->Width, sizeof(buf), buf);
+        ok(hr == S_OK, "%u: CopyPixels error %#x\n", i, hr);
+
+        for (y = 0; y < rc->Height; y++)
+            for (x = 0; x < rc->Width; x++)
+                ok(buf[y * rc->Width + x] == (rc->Y + y) * 16 + rc->X + x,
+                   "%u: got %#x at (%u,%u)\n", i, buf[y * rc->Width + x], x, y);
+    }
+
+    IWICBitmapFrameDecode_Release(frame);
+    IWICBitmapDecoder_Release(decoder);
+
+    /* same image, cut off in the middle of the second row */
+    decoder = create_decoder(png_gray_4x4, 55);
+    ok(decoder != 0, "Failed to load PNG image data\n");
+
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame error %#x\n", hr);
+
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, NULL, 4, sizeof(buf), buf);
+    ok(FAILED(hr), "CopyPixels should fail\n");
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, NULL, 4, sizeof(buf), buf);
+    ok(FAILED(hr), "CopyPixels should fail\n");
+
+    IWICBitmapFrameDecode_Release(frame);
+    IWICBitmapDecoder_Release(decoder);
+}
+
 START_TEST(pngformat)
 {
     HRESULT hr;
@@ -585,6 +657,7 @@ START_TEST(pngformat)
 
     test_color_contexts();
     test_png_palette();
+    test_png_copy_pixels();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
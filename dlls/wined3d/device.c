@@ -3215,9 +3215,7 @@ HRESULT CDECL wined3d_device_clear(struct wined3d_device *device, DWORD rect_cou
         }
     }
 
-    wined3d_cs_emit_clear(device->cs, rect_count, rects, flags, color, depth, stencil);
-
-    return WINED3D_OK;
+    return wined3d_cs_emit_clear(device->cs, rect_count, rects, flags, color, depth, stencil);
 }
 
 void CDECL wined3d_device_set_primitive_type(struct wined3d_device *device,
@@ -5731,6 +5731,239 @@ static void shader_glsl_init_ps_uniform_locations(const struct wined3d_gl_info *
     ps->ycorrection_location = GL_EXTCALL(glGetUniformLocationARB(program_id, "ycorrection"));
 }
 
+/* On-disk cache of linked program binaries, see GL_ARB_get_program_binary.
+ * Entries are keyed by a hash of the process architecture, the GL
+ * implementation strings, the source of every attached shader object and
+ * any link state that isn't part of the sources. 32-bit and 64-bit
+ * processes get different binaries from the driver, so they must not
+ * share entries. Each entry is written to a temporary file that is then
+ * renamed into place, so concurrent processes only ever see complete
+ * entries. Entries the driver rejects are simply relinked and rewritten.
+ * The cache is only used when the ShaderCache setting is "enabled". */
+#define WINED3D_PROGRAM_CACHE_MAGIC     0x50443357 /* "W3DP" */
+#define WINED3D_PROGRAM_CACHE_VERSION   2
+#define WINED3D_PROGRAM_CACHE_MAX_SIZE  (64 * 1024 * 1024)
+
+#if defined(__i386__)
+#define WINED3D_PROGRAM_CACHE_ARCH      "i386"
+#elif defined(__x86_64__)
+#define WINED3D_PROGRAM_CACHE_ARCH      "x86_64"
+#elif defined(__arm__)
+#define WINED3D_PROGRAM_CACHE_ARCH      "arm"
+#elif defined(__aarch64__)
+#define WINED3D_PROGRAM_CACHE_ARCH      "arm64"
+#elif defined(__powerpc__)
+#define WINED3D_PROGRAM_CACHE_ARCH      "powerpc"
+#else
+#define WINED3D_PROGRAM_CACHE_ARCH      "unknown"
+#endif
+
+struct glsl_program_cache_key
+{
+    ULONGLONG hash;
+    ULONGLONG check;
+};
+
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    ULONGLONG hash;
+    ULONGLONG check;
+    GLenum format;
+    DWORD size;
+    ULONGLONG checksum;
+};
+
+static ULONGLONG program_key_fnv1a(ULONGLONG hash, const void *data, size_t size)
+{
+    const BYTE *ptr = data;
+
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+static void program_key_update(struct glsl_program_cache_key *key, const void *data, size_t size)
+{
+    key->hash = program_key_fnv1a(key->hash, data, size);
+    key->check = program_key_fnv1a(key->check ^ 0x5bd1e995, data, size);
+}
+
+static void program_key_update_string(struct glsl_program_cache_key *key, const char *str)
+{
+    if (str) program_key_update(key, str, strlen(str) + 1);
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_get_program_key(const struct wined3d_gl_info *gl_info, GLhandleARB program,
+        const struct wined3d_shader *gshader, struct glsl_program_cache_key *key)
+{
+    struct glsl_program_cache_key sources = {0, 0};
+    GLint i, object_count, source_size = 0;
+    DWORD pointer_size = sizeof(void *);
+    GLhandleARB *objects;
+    char *source = NULL;
+    BOOL ret = TRUE;
+
+    key->hash = key->check = 0xcbf29ce484222325ull;
+    program_key_update_string(key, WINED3D_PROGRAM_CACHE_ARCH);
+    program_key_update(key, &pointer_size, sizeof(pointer_size));
+    program_key_update_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR));
+    program_key_update_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER));
+    program_key_update_string(key, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION));
+
+    GL_EXTCALL(glGetObjectParameterivARB(program, GL_OBJECT_ATTACHED_OBJECTS_ARB, &object_count));
+    if (!(objects = HeapAlloc(GetProcessHeap(), 0, object_count * sizeof(*objects))))
+        return FALSE;
+    GL_EXTCALL(glGetAttachedObjectsARB(program, object_count, NULL, objects));
+
+    /* The attachment order isn't defined, so combine the sources in a way
+     * that doesn't depend on it. */
+    for (i = 0; i < object_count; ++i)
+    {
+        struct glsl_program_cache_key object_key;
+        GLint tmp;
+
+        GL_EXTCALL(glGetObjectParameterivARB(objects[i], GL_OBJECT_SHADER_SOURCE_LENGTH_ARB, &tmp));
+        if (source_size < tmp)
+        {
+            HeapFree(GetProcessHeap(), 0, source);
+            if (!(source = HeapAlloc(GetProcessHeap(), 0, tmp)))
+            {
+                ret = FALSE;
+                break;
+            }
+            source_size = tmp;
+        }
+
+        GL_EXTCALL(glGetShaderSourceARB(objects[i], source_size, &tmp, source));
+        object_key.hash = object_key.check = 0xcbf29ce484222325ull;
+        program_key_update(&object_key, source, tmp);
+        sources.hash += object_key.hash;
+        sources.check += object_key.check;
+    }
+    checkGLcall("get program sources");
+
+    program_key_update(key, &sources, sizeof(sources));
+    if (gshader)
+    {
+        program_key_update(key, &gshader->u.gs.input_type, sizeof(gshader->u.gs.input_type));
+        program_key_update(key, &gshader->u.gs.output_type, sizeof(gshader->u.gs.output_type));
+        program_key_update(key, &gshader->u.gs.vertices_out, sizeof(gshader->u.gs.vertices_out));
+    }
+
+    HeapFree(GetProcessHeap(), 0, source);
+    HeapFree(GetProcessHeap(), 0, objects);
+
+    return ret;
+}
+
+static void shader_glsl_get_program_cache_file(const struct glsl_program_cache_key *key, char *path, size_t size)
+{
+    snprintf(path, size, "%s\\%08x%08x.bin", wined3d_settings.shader_cache_path,
+            (DWORD)(key->hash >> 32), (DWORD)key->hash);
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info, GLhandleARB program,
+        const struct glsl_program_cache_key *key)
+{
+    struct glsl_program_cache_header header;
+    char path[MAX_PATH];
+    void *data = NULL;
+    BOOL ret = FALSE;
+    HANDLE file;
+    DWORD read;
+    GLint status;
+
+    shader_glsl_get_program_cache_file(key, path, sizeof(path));
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (ReadFile(file, &header, sizeof(header), &read, NULL) && read == sizeof(header)
+            && header.magic == WINED3D_PROGRAM_CACHE_MAGIC
+            && header.version == WINED3D_PROGRAM_CACHE_VERSION
+            && header.hash == key->hash && header.check == key->check
+            && header.size && header.size <= WINED3D_PROGRAM_CACHE_MAX_SIZE
+            && (data = HeapAlloc(GetProcessHeap(), 0, header.size))
+            && ReadFile(file, data, header.size, &read, NULL) && read == header.size
+            && program_key_fnv1a(0xcbf29ce484222325ull, data, header.size) == header.checksum)
+    {
+        GL_EXTCALL(glProgramBinary(program, header.format, data, header.size));
+        GL_EXTCALL(glGetObjectParameterivARB(program, GL_OBJECT_LINK_STATUS_ARB, &status));
+        checkGLcall("glProgramBinary");
+        if (!(ret = status))
+            TRACE("Driver rejected cached binary %s.\n", debugstr_a(path));
+    }
+
+    HeapFree(GetProcessHeap(), 0, data);
+    CloseHandle(file);
+
+    return ret;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info, GLhandleARB program,
+        const struct glsl_program_cache_key *key)
+{
+    struct glsl_program_cache_header header;
+    char path[MAX_PATH], tmp_path[MAX_PATH];
+    void *data;
+    HANDLE file;
+    DWORD written;
+    GLint status, size;
+    BOOL ret;
+
+    GL_EXTCALL(glGetObjectParameterivARB(program, GL_OBJECT_LINK_STATUS_ARB, &status));
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size));
+    checkGLcall("glGetProgramiv");
+    if (!status || size <= 0 || size > WINED3D_PROGRAM_CACHE_MAX_SIZE)
+        return;
+
+    if (!(data = HeapAlloc(GetProcessHeap(), 0, size)))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program, size, &size, &header.format, data));
+    checkGLcall("glGetProgramBinary");
+
+    header.magic = WINED3D_PROGRAM_CACHE_MAGIC;
+    header.version = WINED3D_PROGRAM_CACHE_VERSION;
+    header.hash = key->hash;
+    header.check = key->check;
+    header.size = size;
+    header.checksum = program_key_fnv1a(0xcbf29ce484222325ull, data, size);
+
+    CreateDirectoryA(wined3d_settings.shader_cache_path, NULL);
+    shader_glsl_get_program_cache_file(key, path, sizeof(path));
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%x.%x.tmp", path,
+            GetCurrentProcessId(), GetCurrentThreadId()) >= sizeof(tmp_path))
+        file = INVALID_HANDLE_VALUE;
+    else
+        file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+                && WriteFile(file, data, size, &written, NULL) && written == size;
+        CloseHandle(file);
+
+        if (!ret || !MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+        {
+            WARN("Failed to write %s.\n", debugstr_a(path));
+            DeleteFileA(tmp_path);
+        }
+    }
+
+    HeapFree(GetProcessHeap(), 0, data);
+}
+
 /* Context activation is done by the caller. */
 static void set_glsl_shader_program(const struct wined3d_context *context, const struct wined3d_state *state,
         struct shader_glsl_priv *priv, struct glsl_context_data *ctx_data)
@@ -5748,6 +5981,8 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     GLhandleARB gs_id = 0;
     GLhandleARB ps_id = 0;
     struct list *ps_list, *vs_list;
+    struct glsl_program_cache_key key;
+    BOOL use_cache;
 
     if (!(context->shader_update_mask & (1 << WINED3D_SHADER_TYPE_VERTEX)))
     {
@@ -5915,10 +6150,24 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u\n", programId);
-    GL_EXTCALL(glLinkProgramARB(programId));
-    shader_glsl_validate_link(gl_info, programId);
+    use_cache = wined3d_settings.shader_cache_path && gl_info->supported[ARB_GET_PROGRAM_BINARY]
+            && shader_glsl_get_program_key(gl_info, programId, gshader, &key);
+
+    if (use_cache && shader_glsl_load_program_binary(gl_info, programId, &key))
+    {
+        TRACE("Loaded GLSL shader program %u from the shader cache.\n", programId);
+    }
+    else
+    {
+        /* Link the program */
+        TRACE("Linking GLSL shader program %u\n", programId);
+        if (use_cache)
+            GL_EXTCALL(glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        GL_EXTCALL(glLinkProgramARB(programId));
+        shader_glsl_validate_link(gl_info, programId);
+        if (use_cache)
+            shader_glsl_store_program_binary(gl_info, programId, &key);
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, programId, &entry->vs,
             vshader ? vshader->limits.constant_float : 0);
@@ -2785,10 +2785,33 @@ static inline BYTE cliptobyte(int x)
     return (BYTE)((x < 0) ? 0 : ((x > 255) ? 255 : x));
 }
 
+/* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
+ *     C = Y - 16; D = U - 128; E = V - 128;
+ *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
+ *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
+ *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
+ * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
+ * U and V are shared between the pixels, so the chroma terms are computed
+ * once per pair. */
+static inline DWORD yuv_to_x8r8g8b8(int c2, int r2, int g2, int b2)
+{
+    return 0xff000000
+            | cliptobyte((c2 + r2) >> 8) << 16  /* red   */
+            | cliptobyte((c2 + g2) >> 8) << 8   /* green */
+            | cliptobyte((c2 + b2) >> 8);       /* blue  */
+}
+
+static inline WORD yuv_to_r5g6b5(int c2, int r2, int g2, int b2)
+{
+    return (cliptobyte((c2 + r2) >> 8) >> 3) << 11  /* red   */
+            | (cliptobyte((c2 + g2) >> 8) >> 2) << 5    /* green */
+            | (cliptobyte((c2 + b2) >> 8) >> 3);        /* blue  */
+}
+
 static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
         DWORD pitch_in, DWORD pitch_out, unsigned int w, unsigned int h)
 {
-    int c2, d, e, r2 = 0, g2 = 0, b2 = 0;
+    int d, e, r2, g2, b2;
     unsigned int x, y;
 
     TRACE("Converting %ux%u pixels, pitches %u %u.\n", w, h, pitch_in, pitch_out);
@@ -2797,32 +2820,17 @@ static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
     {
         const BYTE *src_line = src + y * pitch_in;
         DWORD *dst_line = (DWORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        for (x = 0; x < w; x += 2, src_line += 4)
         {
-            /* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
-             *     C = Y - 16; D = U - 128; E = V - 128;
-             *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
-             *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
-             *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
-             * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
-             * U and V are shared between the pixels. */
-            if (!(x & 1)) /* For every even pixel, read new U and V. */
-            {
-                d = (int) src_line[1] - 128;
-                e = (int) src_line[3] - 128;
-                r2 = 409 * e + 128;
-                g2 = - 100 * d - 208 * e + 128;
-                b2 = 516 * d + 128;
-            }
-            c2 = 298 * ((int) src_line[0] - 16);
-            dst_line[x] = 0xff000000
-                | cliptobyte((c2 + r2) >> 8) << 16    /* red   */
-                | cliptobyte((c2 + g2) >> 8) << 8     /* green */
-                | cliptobyte((c2 + b2) >> 8);         /* blue  */
-                /* Scale RGB values to 0..255 range,
-                 * then clip them if still not in range (may be negative),
-                 * then shift them within DWORD if necessary. */
-            src_line += 2;
+            d = (int)src_line[1] - 128;
+            e = (int)src_line[3] - 128;
+            r2 = 409 * e + 128;
+            g2 = - 100 * d - 208 * e + 128;
+            b2 = 516 * d + 128;
+
+            dst_line[x] = yuv_to_x8r8g8b8(298 * ((int)src_line[0] - 16), r2, g2, b2);
+            if (x + 1 < w)
+                dst_line[x + 1] = yuv_to_x8r8g8b8(298 * ((int)src_line[2] - 16), r2, g2, b2);
         }
     }
 }
@@ -2830,8 +2838,8 @@ static void convert_yuy2_x8r8g8b8(const BYTE *src, BYTE *dst,
 static void convert_yuy2_r5g6b5(const BYTE *src, BYTE *dst,
         DWORD pitch_in, DWORD pitch_out, unsigned int w, unsigned int h)
 {
+    int d, e, r2, g2, b2;
     unsigned int x, y;
-    int c2, d, e, r2 = 0, g2 = 0, b2 = 0;
 
     TRACE("Converting %ux%u pixels, pitches %u %u\n", w, h, pitch_in, pitch_out);
 
@@ -2839,31 +2847,17 @@ static void convert_yuy2_r5g6b5(const BYTE *src, BYTE *dst,
     {
         const BYTE *src_line = src + y * pitch_in;
         WORD *dst_line = (WORD *)(dst + y * pitch_out);
-        for (x = 0; x < w; ++x)
+        for (x = 0; x < w; x += 2, src_line += 4)
         {
-            /* YUV to RGB conversion formulas from http://en.wikipedia.org/wiki/YUV:
-             *     C = Y - 16; D = U - 128; E = V - 128;
-             *     R = cliptobyte((298 * C + 409 * E + 128) >> 8);
-             *     G = cliptobyte((298 * C - 100 * D - 208 * E + 128) >> 8);
-             *     B = cliptobyte((298 * C + 516 * D + 128) >> 8);
-             * Two adjacent YUY2 pixels are stored as four bytes: Y0 U Y1 V .
-             * U and V are shared between the pixels. */
-            if (!(x & 1)) /* For every even pixel, read new U and V. */
-            {
-                d = (int) src_line[1] - 128;
-                e = (int) src_line[3] - 128;
-                r2 = 409 * e + 128;
-                g2 = - 100 * d - 208 * e + 128;
-                b2 = 516 * d + 128;
-            }
-            c2 = 298 * ((int) src_line[0] - 16);
-            dst_line[x] = (cliptobyte((c2 + r2) >> 8) >> 3) << 11   /* red   */
-                | (cliptobyte((c2 + g2) >> 8) >> 2) << 5            /* green */
-                | (cliptobyte((c2 + b2) >> 8) >> 3);                /* blue  */
-                /* Scale RGB values to 0..255 range,
-                 * then clip them if still not in range (may be negative),
-                 * then shift them within DWORD if necessary. */
-            src_line += 2;
+            d = (int)src_line[1] - 128;
+            e = (int)src_line[3] - 128;
+            r2 = 409 * e + 128;
+            g2 = - 100 * d - 208 * e + 128;
+            b2 = 516 * d + 128;
+
+            dst_line[x] = yuv_to_r5g6b5(298 * ((int)src_line[0] - 16), r2, g2, b2);
+            if (x + 1 < w)
+                dst_line[x + 1] = yuv_to_r5g6b5(298 * ((int)src_line[2] - 16), r2, g2, b2);
         }
     }
 }
@@ -2957,8 +2951,8 @@ static struct wined3d_texture *surface_convert_format(struct wined3d_surface *so
 static HRESULT _Blt_ColorFill(BYTE *buf, unsigned int width, unsigned int height,
         unsigned int bpp, UINT pitch, DWORD color)
 {
+    unsigned int x, y, row_size, filled;
     BYTE *first;
-    unsigned int x, y;
 
     /* Do first row */
 
@@ -2969,10 +2963,11 @@ do { \
         d[x] = (type)color; \
 } while(0)
 
+    row_size = width * bpp;
     switch (bpp)
     {
         case 1:
-            COLORFILL_ROW(BYTE);
+            memset(buf, color, width);
             break;
 
         case 2:
@@ -2980,16 +2975,17 @@ do { \
             break;
 
         case 3:
-        {
-            BYTE *d = buf;
-            for (x = 0; x < width; ++x, d += 3)
-            {
-                d[0] = (color      ) & 0xff;
-                d[1] = (color >>  8) & 0xff;
-                d[2] = (color >> 16) & 0xff;
-            }
+            if (!width)
+                break;
+            /* Store a single pixel and keep doubling it, the row is then
+             * filled with a handful of memcpy() calls. */
+            buf[0] = (color      ) & 0xff;
+            buf[1] = (color >>  8) & 0xff;
+            buf[2] = (color >> 16) & 0xff;
+            for (filled = 3; filled < row_size; filled *= 2)
+                memcpy(buf + filled, buf, min(filled, row_size - filled));
             break;
-        }
+
         case 4:
             COLORFILL_ROW(DWORD);
             break;
@@ -3006,7 +3002,7 @@ do { \
     for (y = 1; y < height; ++y)
     {
         buf += pitch;
-        memcpy(buf, first, width * bpp);
+        memcpy(buf, first, row_size);
     }
 
     return WINED3D_OK;
@@ -5731,13 +5727,10 @@ do { \
                                 BYTE *d = dbuf;
                                 for (x = sx = 0; x < dstwidth; x++, sx+= xinc)
                                 {
-                                    DWORD pixel;
-
                                     s = sbuf + 3 * (sx >> 16);
-                                    pixel = s[0] | (s[1] << 8) | (s[2] << 16);
-                                    d[0] = (pixel      ) & 0xff;
-                                    d[1] = (pixel >>  8) & 0xff;
-                                    d[2] = (pixel >> 16) & 0xff;
+                                    d[0] = s[0];
+                                    d[1] = s[1];
+                                    d[2] = s[2];
                                     d += 3;
                                 }
                                 break;
@@ -5883,23 +5876,39 @@ do { \
                 flags &= ~(WINEDDBLT_DDFX);
             }
 
+            /* Without a destination key every destination pixel passes the
+             * destination test, so don't bother reading it back. */
 #define COPY_COLORKEY_FX(type) \
 do { \
     const type *s; \
     type *d = (type *)dbuf, *dx, tmp; \
+    BOOL dest_key = destkeylow || destkeyhigh != 0xffffffff; \
     for (y = sy = 0; y < dstheight; ++y, sy += yinc) \
     { \
         s = (const type *)(sbase + (sy >> 16) * src_map.row_pitch); \
         dx = d; \
-        for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
+        if (dest_key) \
+        { \
+            for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
+            { \
+                tmp = s[sx >> 16]; \
+                if (((tmp & keymask) < keylow || (tmp & keymask) > keyhigh) \
+                        && ((dx[0] & destkeymask) >= destkeylow && (dx[0] & destkeymask) <= destkeyhigh)) \
+                { \
+                    dx[0] = tmp; \
+                } \
+                dx = (type *)(((BYTE *)dx) + dstxinc); \
+            } \
+        } \
+        else \
         { \
-            tmp = s[sx >> 16]; \
-            if (((tmp & keymask) < keylow || (tmp & keymask) > keyhigh) \
-                    && ((dx[0] & destkeymask) >= destkeylow && (dx[0] & destkeymask) <= destkeyhigh)) \
+            for (x = sx = 0; x < dstwidth; ++x, sx += xinc) \
             { \
-                dx[0] = tmp; \
+                tmp = s[sx >> 16]; \
+                if ((tmp & keymask) < keylow || (tmp & keymask) > keyhigh) \
+                    dx[0] = tmp; \
+                dx = (type *)(((BYTE *)dx) + dstxinc); \
             } \
-            dx = (type *)(((BYTE *)dx) + dstxinc); \
         } \
         d = (type *)(((BYTE *)d) + dstyinc); \
     } \
@@ -85,6 +85,7 @@ struct wined3d_settings wined3d_settings =
     ~0U,            /* No GS shader model limit by default. */
     ~0U,            /* No PS shader model limit by default. */
     FALSE,          /* 3D support enabled by default. */
+    NULL,           /* The shader cache path is set in wined3d_dll_init. */
 };
 
 struct wined3d * CDECL wined3d_create(DWORD flags)
@@ -131,6 +132,16 @@ static DWORD get_config_key_dword(HKEY defkey, HKEY appkey, const char *name, DW
     return ERROR_FILE_NOT_FOUND;
 }
 
+static void set_shader_cache_path(const char *path)
+{
+    size_t len = strlen(path) + 1;
+
+    if (!(wined3d_settings.shader_cache_path = HeapAlloc(GetProcessHeap(), 0, len)))
+        ERR("Failed to allocate shader cache path memory.\n");
+    else
+        memcpy(wined3d_settings.shader_cache_path, path, len);
+}
+
 static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
 {
     DWORD wined3d_context_tls_idx;
@@ -139,6 +150,7 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
     HKEY hkey = 0;
     HKEY appkey = 0;
     DWORD len, tmpvalue;
+    BOOL cache_enabled = FALSE;
     WNDCLASSA wc;
 
     wined3d_context_tls_idx = TlsAlloc();
@@ -304,7 +316,30 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Disabling 3D support.\n");
             wined3d_settings.no_3d = TRUE;
         }
+        if (!get_config_key(hkey, appkey, "ShaderCache", buffer, size)
+                && !strcmp(buffer, "enabled"))
+        {
+            TRACE("Enabling the shader cache.\n");
+            cache_enabled = TRUE;
+        }
+        if (cache_enabled && !get_config_key(hkey, appkey, "ShaderCachePath", buffer, size))
+            set_shader_cache_path(buffer);
+    }
+
+    if (cache_enabled && !wined3d_settings.shader_cache_path)
+    {
+        /* Keep linked GLSL programs with the per-user application data in the prefix. */
+        len = GetEnvironmentVariableA("LOCALAPPDATA", buffer, MAX_PATH);
+        if (!len || len >= MAX_PATH)
+            len = GetTempPathA(MAX_PATH, buffer);
+        if (len && len + sizeof("\\wined3d_shader_cache") <= MAX_PATH)
+        {
+            if (buffer[len - 1] == '\\') buffer[--len] = 0;
+            strcat(buffer, "\\wined3d_shader_cache");
+            set_shader_cache_path(buffer);
+        }
     }
+    TRACE("Shader cache path %s.\n", debugstr_a(wined3d_settings.shader_cache_path));
 
     if (appkey) RegCloseKey( appkey );
     if (hkey) RegCloseKey( hkey );
@@ -336,6 +371,7 @@ static BOOL wined3d_dll_destroy(HINSTANCE hInstDLL)
     HeapFree(GetProcessHeap(), 0, wndproc_table.entries);
 
     HeapFree(GetProcessHeap(), 0, wined3d_settings.logo);
+    HeapFree(GetProcessHeap(), 0, wined3d_settings.shader_cache_path);
     UnregisterClassA(WINED3D_OPENGL_WINDOW_CLASS_NAME, hInstDLL);
 
     DeleteCriticalSection(&wined3d_wndproc_cs);
@@ -644,6 +644,22 @@ typedef union
     } create_thread;
 } apc_result_t;
 
+
+typedef struct
+{
+    obj_handle_t     handle;
+    int              __pad;
+    apc_call_t       call;
+} select_apc_call_t;
+
+
+typedef struct
+{
+    obj_handle_t     handle;
+    int              __pad;
+    apc_result_t     result;
+} select_apc_result_t;
+
 struct rawinput_device
 {
     unsigned short usage_page;
@@ -1087,8 +1103,8 @@ struct select_request
     int          flags;
     client_ptr_t cookie;
     timeout_t    timeout;
-    obj_handle_t prev_apc;
-    /* VARARG(result,apc_result); */
+    data_size_t  result_size;
+    /* VARARG(results,select_apc_results,result_size); */
     /* VARARG(data,select_op); */
     char __pad_36[4];
 };
@@ -1096,9 +1112,7 @@ struct select_reply
 {
     struct reply_header __header;
     timeout_t    timeout;
-    apc_call_t   call;
-    obj_handle_t apc_handle;
-    char __pad_60[4];
+    /* VARARG(apcs,select_apc_calls); */
 };
 #define SELECT_ALERTABLE     1
 #define SELECT_INTERRUPTIBLE 2
@@ -2078,6 +2092,7 @@ struct create_mapping_reply
 #define VPROT_SYSTEM     0x0200
 #define VPROT_VALLOC     0x0400
 #define VPROT_NOEXEC     0x0800
+#define VPROT_LARGE_PAGES 0x1000
 
 
 
@@ -2114,6 +2129,8 @@ struct get_mapping_info_reply
     client_ptr_t base;
     obj_handle_t mapping;
     obj_handle_t shared_file;
+    obj_handle_t image_file;
+    char __pad_44[4];
 };
 
 
@@ -5862,6 +5879,6 @@ union generic_reply
     struct set_suspend_context_reply set_suspend_context_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 454
+#define SERVER_PROTOCOL_VERSION 457
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -439,6 +439,9 @@ static int active_users;                    /* current number of active users */
 static int allocated_users;                 /* count of allocated entries in the array */
 static struct fd **freelist;                /* list of free entries in the array */
 
+static unsigned int poll_ctl_calls;        /* number of event mask updates sent to the kernel */
+static unsigned int poll_ctl_avoided;      /* number of event mask updates that were not needed */
+
 static int get_next_timeout(void);
 
 static inline void fd_poll_event( struct fd *fd, int event )
@@ -449,16 +452,53 @@ static inline void fd_poll_event( struct fd *fd, int event )
 #ifdef USE_EPOLL
 
 static int epoll_fd = -1;
+static int *epoll_events;                   /* events currently registered with epoll for each user */
+static int epoll_allocated;                 /* count of allocated entries in the epoll_events array */
 
 static inline void init_epoll(void)
 {
     epoll_fd = epoll_create( 128 );
 }
 
+/* update the events registered with epoll for a given user */
+static void epoll_ctl_user( struct fd *fd, int user, int ctl, int events )
+{
+    struct epoll_event ev;
+
+    if (user >= epoll_allocated)
+    {
+        int *new_events, new_count = allocated_users;
+
+        if (!(new_events = realloc( epoll_events, new_count * sizeof(*epoll_events) )))
+        {
+            close( epoll_fd );  /* not enough memory, give up on epoll */
+            epoll_fd = -1;
+            return;
+        }
+        epoll_events = new_events;
+        epoll_allocated = new_count;
+    }
+
+    ev.events = events;
+    memset(&ev.data, 0, sizeof(ev.data));
+    ev.data.u32 = user;
+
+    poll_ctl_calls++;
+    if (epoll_ctl( epoll_fd, ctl, fd->unix_fd, &ev ) == -1)
+    {
+        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
+        {
+            close( epoll_fd );
+            epoll_fd = -1;
+        }
+        else perror( "epoll_ctl" );  /* should not happen */
+    }
+    else epoll_events[user] = events;
+}
+
 /* set the events that epoll waits for on this fd; helper for set_fd_events */
 static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
 {
-    struct epoll_event ev;
     int ctl;
 
     if (epoll_fd == -1) return;
@@ -476,22 +516,17 @@ static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
     else
     {
         if (pollfd[user].events == events) return;  /* nothing to do */
-        ctl = EPOLL_CTL_MOD;
-    }
-
-    ev.events = events;
-    memset(&ev.data, 0, sizeof(ev.data));
-    ev.data.u32 = user;
-
-    if (epoll_ctl( epoll_fd, ctl, fd->unix_fd, &ev ) == -1)
-    {
-        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
+        /* events we are no longer interested in are only removed from the epoll
+         * set once they actually occur, as the interest often comes back before that */
+        if (!(events & ~epoll_events[user]))
         {
-            close( epoll_fd );
-            epoll_fd = -1;
+            poll_ctl_avoided++;
+            return;
         }
-        else perror( "epoll_ctl" );  /* should not happen */
+        ctl = EPOLL_CTL_MOD;
     }
+
+    epoll_ctl_user( fd, user, ctl, events );
 }
 
 static inline void remove_epoll_user( struct fd *fd, int user )
@@ -531,7 +566,12 @@ static inline void main_loop_epoll(void)
         for (i = 0; i < ret; i++)
         {
             int user = events[i].data.u32;
-            pollfd[user].revents = events[i].events;
+            int mask = pollfd[user].events | POLLERR | POLLHUP;
+
+            pollfd[user].revents = events[i].events & mask;
+            /* now stop waiting for the events that are no longer wanted */
+            if (epoll_fd != -1 && (events[i].events & ~mask))
+                epoll_ctl_user( poll_users[user], user, EPOLL_CTL_MOD, pollfd[user].events );
         }
 
         /* read events from the pollfd array, as set_fd_events may modify them */
@@ -909,6 +949,13 @@ void main_loop(void)
     }
 }
 
+/* print the event mask update statistics of the main loop */
+void dump_poll_stats(void)
+{
+    fprintf( stderr, "wineserver: %u event mask updates, %u avoided\n",
+             poll_ctl_calls, poll_ctl_avoided );
+}
+
 
 /****************************************************************/
 /* device functions */
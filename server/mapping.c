@@ -67,6 +67,10 @@ struct mapping
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct file    *shared_file;     /* temp file for shared PE mapping */
     struct list     shared_entry;    /* entry in global shared PE mappings list */
+    struct file    *image_file;      /* temp file for page-aligned PE image layout */
+    struct list     image_entry;     /* entry in global PE image layouts list */
+    off_t           image_size;      /* size of the PE file the layout was built from */
+    time_t          image_mtime;     /* modification time of the PE file the layout was built from */
 };
 
 static void mapping_dump( struct object *obj, int verbose );
@@ -109,6 +113,7 @@ static const struct fd_ops mapping_fd_ops =
 };
 
 static struct list shared_list = LIST_INIT(shared_list);
+static struct list image_list = LIST_INIT(image_list);
 
 static size_t page_mask;
 
@@ -205,6 +210,19 @@ static struct file *get_shared_file( struct mapping *mapping )
     return NULL;
 }
 
+/* find the page-aligned image layout for a given mapping */
+static struct file *get_image_file( struct mapping *mapping, const struct stat *st )
+{
+    struct mapping *ptr;
+
+    /* the file may have been rewritten in place, so the inode alone isn't enough */
+    LIST_FOR_EACH_ENTRY( ptr, &image_list, struct mapping, image_entry )
+        if (is_same_file_fd( ptr->fd, mapping->fd ) &&
+            ptr->image_size == st->st_size && ptr->image_mtime == st->st_mtime)
+            return (struct file *)grab_object( ptr->image_file );
+    return NULL;
+}
+
 /* return the size of the memory mapping and file range of a given section */
 static inline void get_section_sizes( const IMAGE_SECTION_HEADER *sec, size_t *map_size,
                                       off_t *file_start, size_t *file_size )
@@ -367,6 +385,96 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     return 0;
 }
 
+/* copy a range of the PE file into the image layout file, stopping at end of file */
+static int copy_image_range( int fd, int image_fd, char *buffer, size_t size,
+                             off_t read_pos, off_t write_pos )
+{
+    size_t done = 0;
+
+    while (done < size)
+    {
+        long res = pread( fd, buffer + done, size - done, read_pos + done );
+        if (!res) break;
+        if (res < 0) return 0;
+        done += res;
+    }
+    return pwrite( image_fd, buffer, done, write_pos ) == done;
+}
+
+/* largest amount of data copied into an image layout file; the copy blocks the
+ * whole server, so bigger images are left to the client to read */
+#define MAX_IMAGE_LAYOUT_COPY (4 * 1024 * 1024)
+
+/* allocate and fill the temp file containing the PE image with its sections at their
+ * virtual addresses, so that the client can mmap sections that are not page-aligned
+ * in the file instead of reading them, and share the pages with the other processes */
+static void build_image_mapping( struct mapping *mapping, int fd, unsigned int section_align,
+                                 IMAGE_SECTION_HEADER *sec, unsigned int nb_sec )
+{
+    unsigned int i;
+    size_t file_size, map_size, max_size, total_size;
+    off_t read_pos;
+    char *buffer = NULL;
+    int image_fd, unaligned = 0;
+    struct stat st;
+
+    if (section_align <= page_mask) return;  /* the file is mapped as a whole in that case */
+    if (fstat( fd, &st ) == -1) return;
+
+    max_size = total_size = mapping->header_size;
+    for (i = 0; i < nb_sec; i++)
+    {
+        if ((sec[i].Characteristics & IMAGE_SCN_MEM_SHARED) &&
+            (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE)) continue;
+        get_section_sizes( &sec[i], &map_size, &read_pos, &file_size );
+        if (!sec[i].PointerToRawData || !file_size) continue;
+        if ((mem_size_t)sec[i].VirtualAddress + map_size > mapping->size) return;  /* invalid image */
+        if (sec[i].VirtualAddress & page_mask) return;
+        if (read_pos & page_mask) unaligned = 1;
+        if (file_size > max_size) max_size = file_size;
+        total_size += file_size;
+    }
+    if (!unaligned) return;  /* the sections can be mapped straight from the file */
+
+    mapping->image_size  = st.st_size;
+    mapping->image_mtime = st.st_mtime;
+    if ((mapping->image_file = get_image_file( mapping, &st )))
+    {
+        list_add_head( &image_list, &mapping->image_entry );
+        return;
+    }
+    if (total_size > MAX_IMAGE_LAYOUT_COPY) return;
+
+    if ((image_fd = create_temp_file( mapping->size )) == -1) goto error;
+    if (!(mapping->image_file = create_file_for_fd( image_fd, FILE_GENERIC_READ|FILE_GENERIC_WRITE, 0 )))
+        goto error;
+
+    if (!(buffer = malloc( max_size ))) goto error;
+
+    /* copy the headers and the private sections data into the temp file */
+
+    if (!copy_image_range( fd, image_fd, buffer, mapping->header_size, 0, 0 )) goto error;
+    for (i = 0; i < nb_sec; i++)
+    {
+        if ((sec[i].Characteristics & IMAGE_SCN_MEM_SHARED) &&
+            (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE)) continue;
+        get_section_sizes( &sec[i], &map_size, &read_pos, &file_size );
+        if (!sec[i].PointerToRawData || !file_size) continue;
+        if (!copy_image_range( fd, image_fd, buffer, file_size, read_pos, sec[i].VirtualAddress ))
+            goto error;
+    }
+    free( buffer );
+    list_add_head( &image_list, &mapping->image_entry );
+    return;
+
+ error:
+    /* the client falls back to reading the file */
+    if (mapping->image_file) release_object( mapping->image_file );
+    mapping->image_file = NULL;
+    free( buffer );
+    clear_error();
+}
+
 /* retrieve the mapping parameters for an executable (PE) image */
 static unsigned int get_image_params( struct mapping *mapping, int unix_fd, int protect )
 {
@@ -384,6 +492,7 @@ static unsigned int get_image_params( struct mapping *mapping, int unix_fd, int
     } nt;
     off_t pos;
     int size;
+    unsigned int section_align = 0;
 
     /* load the headers */
 
@@ -436,11 +545,13 @@ static unsigned int get_image_params( struct mapping *mapping, int unix_fd, int
         mapping->size        = ROUND_SIZE( nt.opt.hdr32.SizeOfImage );
         mapping->base        = nt.opt.hdr32.ImageBase;
         mapping->header_size = nt.opt.hdr32.SizeOfHeaders;
+        section_align        = nt.opt.hdr32.SectionAlignment;
         break;
     case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
         mapping->size        = ROUND_SIZE( nt.opt.hdr64.SizeOfImage );
         mapping->base        = nt.opt.hdr64.ImageBase;
         mapping->header_size = nt.opt.hdr64.SizeOfHeaders;
+        section_align        = nt.opt.hdr64.SectionAlignment;
         break;
     }
 
@@ -457,6 +568,8 @@ static unsigned int get_image_params( struct mapping *mapping, int unix_fd, int
 
     if (mapping->shared_file) list_add_head( &shared_list, &mapping->shared_entry );
 
+    build_image_mapping( mapping, unix_fd, section_align, sec, nt.FileHeader.NumberOfSections );
+
     mapping->protect = protect;
     free( sec );
     return 0;
@@ -492,6 +605,7 @@ static struct object *create_mapping( struct directory *root, const struct unico
     mapping->base        = 0;
     mapping->fd          = NULL;
     mapping->shared_file = NULL;
+    mapping->image_file  = NULL;
     mapping->committed   = NULL;
 
     if (protect & VPROT_READ) access |= FILE_READ_DATA;
@@ -602,10 +716,10 @@ static void mapping_dump( struct object *obj, int verbose )
     struct mapping *mapping = (struct mapping *)obj;
     assert( obj->ops == &mapping_ops );
     fprintf( stderr, "Mapping size=%08x%08x prot=%08x fd=%p header_size=%08x base=%08lx "
-             "shared_file=%p ",
+             "shared_file=%p image_file=%p ",
              (unsigned int)(mapping->size >> 32), (unsigned int)mapping->size,
              mapping->protect, mapping->fd, mapping->header_size,
-             (unsigned long)mapping->base, mapping->shared_file );
+             (unsigned long)mapping->base, mapping->shared_file, mapping->image_file );
     dump_object_name( &mapping->obj );
     fputc( '\n', stderr );
 }
@@ -642,6 +756,11 @@ static void mapping_destroy( struct object *obj )
         release_object( mapping->shared_file );
         list_remove( &mapping->shared_entry );
     }
+    if (mapping->image_file)
+    {
+        release_object( mapping->image_file );
+        list_remove( &mapping->image_entry );
+    }
     free( mapping->committed );
 }
 
@@ -728,6 +847,7 @@ DECL_HANDLER(get_mapping_info)
     reply->header_size = mapping->header_size;
     reply->base        = mapping->base;
     reply->shared_file = 0;
+    reply->image_file  = 0;
     if ((fd = get_obj_fd( &mapping->obj )))
     {
         if (!is_fd_removable(fd)) reply->mapping = alloc_handle( current->process, mapping, 0, 0 );
@@ -741,6 +861,12 @@ DECL_HANDLER(get_mapping_info)
             if (reply->mapping) close_handle( current->process, reply->mapping );
         }
     }
+    if (mapping->image_file && !get_error())
+    {
+        /* failing to return it is not fatal, the client reads the file instead */
+        if (!(reply->image_file = alloc_handle( current->process, mapping->image_file, GENERIC_READ, 0 )))
+            clear_error();
+    }
     release_object( mapping );
 }
 
@@ -820,7 +820,11 @@ static void close_socket_timeout( void *arg )
 {
     master_timeout = NULL;
     flush_registry();
-    if (debug_level) fprintf( stderr, "wineserver: exiting (pid=%ld)\n", (long) getpid() );
+    if (debug_level)
+    {
+        dump_poll_stats();
+        fprintf( stderr, "wineserver: exiting (pid=%ld)\n", (long) getpid() );
+    }
 
 #ifdef DEBUG_OBJECTS
     close_objects();  /* shut down everything properly */
@@ -1404,72 +1404,129 @@ DECL_HANDLER(resume_thread)
     }
 }
 
+/* store the result of an APC run by the client; helper for the select request */
+static int set_apc_result( const select_apc_result_t *result )
+{
+    struct thread_apc *apc;
+
+    if (!(apc = (struct thread_apc *)get_handle_obj( current->process, result->handle,
+                                                     0, &thread_apc_ops ))) return 0;
+    apc->result = result->result;
+    apc->executed = 1;
+    if (apc->result.type == APC_CREATE_THREAD)  /* transfer the handle to the caller process */
+    {
+        obj_handle_t handle = duplicate_handle( current->process, apc->result.create_thread.handle,
+                                                apc->caller->process, 0, 0, DUP_HANDLE_SAME_ACCESS );
+        close_handle( current->process, apc->result.create_thread.handle );
+        apc->result.create_thread.handle = handle;
+        clear_error();  /* ignore errors from the above calls */
+    }
+    else if (apc->result.type == APC_ASYNC_IO)
+    {
+        if (apc->owner)
+            async_set_result( apc->owner, apc->result.async_io.status,
+                              apc->result.async_io.total, apc->result.async_io.apc );
+    }
+    wake_up( &apc->obj, 0 );
+    close_handle( current->process, result->handle );
+    release_object( apc );
+    return 1;
+}
+
+/* check if an APC can be returned in the same select reply as a previous one */
+static inline int can_batch_apc( enum apc_type prev, enum apc_type type )
+{
+    switch (prev)
+    {
+    case APC_USER:
+    case APC_TIMER:
+        return (type == APC_USER || type == APC_TIMER);
+    case APC_ASYNC_IO:
+        /* other system APCs have a caller waiting for the result, don't delay it */
+        return (type == APC_ASYNC_IO);
+    default:
+        return 0;
+    }
+}
+
 /* select on a handle list */
 DECL_HANDLER(select)
 {
     select_op_t select_op;
-    data_size_t op_size;
+    data_size_t i, op_size, count, max_count;
     struct thread_apc *apc;
-    const apc_result_t *result = get_req_data();
+    select_apc_call_t *calls;
+    const select_apc_result_t *result = get_req_data();
 
-    if (get_req_data_size() < sizeof(*result))
+    if (req->result_size > get_req_data_size() || req->result_size % sizeof(*result))
     {
         set_error( STATUS_INVALID_PARAMETER );
         return;
     }
-    op_size = min( get_req_data_size() - sizeof(*result), sizeof(select_op) );
+    op_size = min( get_req_data_size() - req->result_size, sizeof(select_op) );
     memset( &select_op, 0, sizeof(select_op) );
-    memcpy( &select_op, result + 1, op_size );
+    memcpy( &select_op, (const char *)result + req->result_size, op_size );
+
+    /* first store results of previous apcs */
+    for (i = 0; i < req->result_size / sizeof(*result); i++)
+        if (!set_apc_result( &result[i] )) return;
+
+    reply->timeout = select_on( &select_op, op_size, req->cookie, req->flags, req->timeout );
+
+    if (get_error() != STATUS_USER_APC) return;
+
+    /* return as many pending APCs as the client can take in a single reply */
+    max_count = get_reply_max_size() / sizeof(*calls);
+    if (!max_count || !(calls = mem_alloc( max_count * sizeof(*calls) ))) return;
 
-    /* first store results of previous apc */
-    if (req->prev_apc)
+    for (count = 0; count < max_count; )
     {
-        if (!(apc = (struct thread_apc *)get_handle_obj( current->process, req->prev_apc,
-                                                         0, &thread_apc_ops ))) return;
-        apc->result = *result;
-        apc->executed = 1;
-        if (apc->result.type == APC_CREATE_THREAD)  /* transfer the handle to the caller process */
+        if (!(apc = thread_dequeue_apc( current, !(req->flags & SELECT_ALERTABLE) )))
+            break;
+        /* Optimization: ignore APC_NONE calls, they are only used to
+         * wake up a thread, but since we got here the thread woke up already.
+         */
+        if (apc->call.type == APC_NONE)
         {
-            obj_handle_t handle = duplicate_handle( current->process, apc->result.create_thread.handle,
-                                                    apc->caller->process, 0, 0, DUP_HANDLE_SAME_ACCESS );
-            close_handle( current->process, apc->result.create_thread.handle );
-            apc->result.create_thread.handle = handle;
-            clear_error();  /* ignore errors from the above calls */
+            apc->executed = 1;
+            wake_up( &apc->obj, 0 );
+            release_object( apc );
+            continue;
         }
-        else if (apc->result.type == APC_ASYNC_IO)
+        if (count && !can_batch_apc( calls[0].call.type, apc->call.type ))
         {
-            if (apc->owner)
-                async_set_result( apc->owner, apc->result.async_io.status,
-                                  apc->result.async_io.total, apc->result.async_io.apc );
+            /* put it back at the head of its queue for the next select */
+            list_add_head( get_apc_queue( current, apc->call.type ), &apc->entry );
+            break;
         }
-        wake_up( &apc->obj, 0 );
-        close_handle( current->process, req->prev_apc );
-        release_object( apc );
-    }
-
-    reply->timeout = select_on( &select_op, op_size, req->cookie, req->flags, req->timeout );
-
-    if (get_error() == STATUS_USER_APC)
-    {
-        for (;;)
+        if (get_apc_queue( current, apc->call.type ) == &current->user_apc)
         {
-            if (!(apc = thread_dequeue_apc( current, !(req->flags & SELECT_ALERTABLE) )))
-                break;
-            /* Optimization: ignore APC_NONE calls, they are only used to
-             * wake up a thread, but since we got here the thread woke up already.
-             */
-            if (apc->call.type != APC_NONE)
+            /* user APCs don't return a result, consider them done */
+            calls[count].handle = 0;
+            apc->executed = 1;
+            wake_up( &apc->obj, 0 );
+        }
+        else if (!(calls[count].handle = alloc_handle( current->process, apc, SYNCHRONIZE, 0 )))
+        {
+            if (!count)
             {
-                if ((reply->apc_handle = alloc_handle( current->process, apc, SYNCHRONIZE, 0 )))
-                    reply->call = apc->call;
                 release_object( apc );
                 break;
             }
-            apc->executed = 1;
-            wake_up( &apc->obj, 0 );
-            release_object( apc );
+            /* still return the APCs we already have, retry this one on the next select */
+            list_add_head( get_apc_queue( current, apc->call.type ), &apc->entry );
+            clear_error();
+            set_error( STATUS_USER_APC );
+            break;
         }
+        calls[count].__pad = 0;
+        calls[count].call = apc->call;
+        release_object( apc );
+        count++;
     }
+
+    if (count) set_reply_data_ptr( calls, count * sizeof(*calls) );
+    else free( calls );
 }
 
 /* queue an APC for a thread or process */
@@ -368,15 +368,39 @@ static void dump_varargs_uints64( const char *prefix, data_size_t size )
     remove_data( size );
 }
 
-static void dump_varargs_apc_result( const char *prefix, data_size_t size )
+static void dump_varargs_select_apc_calls( const char *prefix, data_size_t size )
 {
-    const apc_result_t *result = cur_data;
+    const select_apc_call_t *apc = cur_data;
+    data_size_t len = size / sizeof(*apc);
 
-    if (size >= sizeof(*result))
+    fprintf( stderr,"%s{", prefix );
+    while (len > 0)
+    {
+        fprintf( stderr, "{handle=%04x", apc->handle );
+        dump_apc_call( ",call=", &apc->call );
+        fputc( '}', stderr );
+        apc++;
+        if (--len) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+    remove_data( size );
+}
+
+static void dump_varargs_select_apc_results( const char *prefix, data_size_t size )
+{
+    const select_apc_result_t *res = cur_data;
+    data_size_t len = size / sizeof(*res);
+
+    fprintf( stderr,"%s{", prefix );
+    while (len > 0)
     {
-        dump_apc_result( prefix, result );
-        size = sizeof(*result);
+        fprintf( stderr, "{handle=%04x", res->handle );
+        dump_apc_result( ",result=", &res->result );
+        fputc( '}', stderr );
+        res++;
+        if (--len) fputc( ',', stderr );
     }
+    fputc( '}', stderr );
     remove_data( size );
 }
 
@@ -1401,16 +1425,15 @@ static void dump_select_request( const struct select_request *req )
     fprintf( stderr, " flags=%d", req->flags );
     dump_uint64( ", cookie=", &req->cookie );
     dump_timeout( ", timeout=", &req->timeout );
-    fprintf( stderr, ", prev_apc=%04x", req->prev_apc );
-    dump_varargs_apc_result( ", result=", cur_size );
+    fprintf( stderr, ", result_size=%u", req->result_size );
+    dump_varargs_select_apc_results( ", results=", min(cur_size,req->result_size) );
     dump_varargs_select_op( ", data=", cur_size );
 }
 
 static void dump_select_reply( const struct select_reply *req )
 {
     dump_timeout( " timeout=", &req->timeout );
-    dump_apc_call( ", call=", &req->call );
-    fprintf( stderr, ", apc_handle=%04x", req->apc_handle );
+    dump_varargs_select_apc_calls( ", apcs=", cur_size );
 }
 
 static void dump_create_event_request( const struct create_event_request *req )
@@ -2069,6 +2092,7 @@ static void dump_get_mapping_info_reply( const struct get_mapping_info_reply *re
     dump_uint64( ", base=", &req->base );
     fprintf( stderr, ", mapping=%04x", req->mapping );
     fprintf( stderr, ", shared_file=%04x", req->shared_file );
+    fprintf( stderr, ", image_file=%04x", req->image_file );
 }
 
 static void dump_get_mapping_committed_range_request( const struct get_mapping_committed_range_request *req )